@@ -0,0 +1,163 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+// heap allocation accounting, every operator new is charged to the calling thread's current subsystem
+enum AllocSubsystem { ALLOC_OTHER, ALLOC_SIM, ALLOC_RENDER, ALLOC_AI, ALLOC_INPUT, ALLOC_ARENA, ALLOC_SUBSYSTEMS };
+
+class AllocStats {
+private:
+    inline static std::atomic<uint64_t> counts[ALLOC_SUBSYSTEMS];
+    inline static std::atomic<uint64_t> bytes[ALLOC_SUBSYSTEMS];
+    inline static thread_local int current = ALLOC_OTHER;
+    inline static thread_local uint64_t threadCount = 0;
+
+public:
+    static void record(size_t size) {
+        counts[current].fetch_add(1, std::memory_order_relaxed);
+        bytes[current].fetch_add(size, std::memory_order_relaxed);
+        threadCount++;
+    }
+
+    static void recordIn(int subsystem, size_t size) {
+        counts[subsystem].fetch_add(1, std::memory_order_relaxed);
+        bytes[subsystem].fetch_add(size, std::memory_order_relaxed);
+        threadCount++;
+    }
+
+    // allocations made by this thread so far, diff two reads to check a code path
+    static uint64_t threadAllocations() {
+        return threadCount;
+    }
+
+    static int setSubsystem(int subsystem) {
+        int old = current;
+        current = subsystem;
+        return old;
+    }
+
+    static uint64_t getCount(int subsystem) {
+        return counts[subsystem].load(std::memory_order_relaxed);
+    }
+
+    static uint64_t getBytes(int subsystem) {
+        return bytes[subsystem].load(std::memory_order_relaxed);
+    }
+
+    static const char* name(int subsystem) {
+        static const char* names[ALLOC_SUBSYSTEMS] = {"other", "sim", "render", "ai", "input", "arena"};
+        return names[subsystem];
+    }
+
+    static std::string report() {
+        std::ostringstream out;
+        for (int i = 0; i < ALLOC_SUBSYSTEMS; ++i)
+            out << name(i) << ": " << getCount(i) << " allocs, " << getBytes(i) << " bytes\n";
+        return out.str();
+    }
+};
+
+// charge allocations in this scope to a subsystem
+class AllocScope {
+private:
+    int old;
+
+public:
+    AllocScope(int subsystem) : old(AllocStats::setSubsystem(subsystem)) {}
+    ~AllocScope() {
+        AllocStats::setSubsystem(old);
+    }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+};
+
+/*
+    Bump allocator for per-match and per-frame memory.
+    Objects are placed into large blocks and the whole arena is released in one shot by reset(),
+    which rewinds to the first block and keeps every block for the next match or frame.
+    Destructors are not run, owners must destroy non-trivial objects before reset().
+*/
+class Arena {
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current; // block being filled
+    size_t offset; // next free byte in the current block
+    size_t blockSize;
+    size_t used;
+
+    void addBlock(size_t minSize) {
+        size_t size = std::max(blockSize, minSize);
+        char* data = static_cast<char*>(std::malloc(size));
+        if (!data) throw std::bad_alloc();
+        AllocStats::recordIn(ALLOC_ARENA, size);
+        blocks.push_back({data, size});
+    }
+
+public:
+    explicit Arena(size_t size = 64 * 1024) : current(0), offset(0), blockSize(size), used(0) {
+        blocks.reserve(16);
+        addBlock(blockSize);
+    }
+
+    ~Arena() {
+        for (auto& b : blocks) std::free(b.data);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        while (true) {
+            Block& b = blocks[current];
+            size_t start = (offset + align - 1) & ~(align - 1);
+            if (start + size <= b.size) {
+                offset = start + size;
+                used += size;
+                return b.data + start;
+            }
+            // move on to the next block, grow only when every block is in use
+            if (current + 1 == blocks.size()) addBlock(size + align);
+            current++;
+            offset = 0;
+        }
+    }
+
+    template<class T, class... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<class T>
+    T* allocArray(size_t n) {
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    // free everything at once, the blocks stay for reuse
+    void reset() {
+        current = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    size_t bytesUsed() const {
+        return used;
+    }
+
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for (auto& b : blocks) total += b.size;
+        return total;
+    }
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+
+// frame time statistics of the render loop
+class FrameStats {
+private:
+    double targetMs; // expected frame time
+    long long frames;
+    long long missed; // frames that took longer than 1.5 target
+    double meanMs, m2; // running mean & variance (Welford)
+    double worstMs;
+    std::mutex mtx;
+
+public:
+    struct Snapshot {
+        long long frames;
+        long long missed;
+        double avgMs;
+        double jitterMs; // standard deviation of the frame time
+        double worstMs;
+        double fps;
+    };
+
+    FrameStats(double target = 1000.0 / 60) :
+        targetMs(target), frames(0), missed(0), meanMs(0), m2(0), worstMs(0){}
+
+    void setTarget(double target){
+        std::lock_guard<std::mutex> lock(mtx);
+        targetMs = target;
+    }
+
+    void reset(){
+        std::lock_guard<std::mutex> lock(mtx);
+        frames = 0;
+        missed = 0;
+        meanMs = 0;
+        m2 = 0;
+        worstMs = 0;
+    }
+
+    void addFrame(double ms){
+        std::lock_guard<std::mutex> lock(mtx);
+        frames++;
+        double delta = ms - meanMs;
+        meanMs += delta / frames;
+        m2 += delta * (ms - meanMs);
+        worstMs = std::max(worstMs, ms);
+        if(ms > targetMs * 1.5)
+            missed++;
+    }
+
+    Snapshot get(){
+        std::lock_guard<std::mutex> lock(mtx);
+        Snapshot s;
+        s.frames = frames;
+        s.missed = missed;
+        s.avgMs = meanMs;
+        s.jitterMs = frames > 1 ? std::sqrt(m2 / (frames - 1)) : 0;
+        s.worstMs = worstMs;
+        s.fps = meanMs > 0 ? 1000.0 / meanMs : 0;
+        return s;
+    }
+};
@@ -0,0 +1,273 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <type_traits>
+#include "Objects.h"
+
+/*
+    Compact game state for lookahead search.
+    Walls never change during a match, so they live in one read-only WallGrid that every clone points to.
+    Everything that does change (tanks, bullets, tick) is a fixed-size POD, a clone is a plain memcpy.
+*/
+
+struct WallGrid {
+    int width = 0, height = 0;
+    std::vector<uint8_t> cells; // 1 = wall
+
+    void load(Map& map){
+        std::vector<std::pair<char, int>> grid;
+        map.copyCells(grid);
+        width = map.getwidth();
+        height = map.getheight();
+        cells.resize(grid.size());
+        for(size_t i = 0; i < grid.size(); ++i)
+            cells[i] = grid[i].first == map.wall;
+    }
+};
+
+struct SimTank {
+    int16_t x, y;
+    int8_t health;
+    char direction; // 'w', 'a', 's', 'd'
+    int8_t cooldown; // ticks until the next shot
+    int8_t bullets; // live bullets
+    int16_t nextThink; // ticks until the next decision
+};
+
+struct SimBullet {
+    int16_t x, y;
+    int8_t dx, dy;
+    int8_t owner;
+    int8_t pad;
+};
+
+/*
+    One ai decision, shaped like Match::think: a horizontal step, then a vertical step, then an optional shot.
+    Encoded as (dx + 1) + (dy + 1) * 3 + shoot * 9, ACT_STAY stands still and holds fire.
+*/
+const uint8_t ACT_STAY = 4;
+const uint8_t ACT_COUNT = 18;
+
+inline uint8_t makeAction(int dx, int dy, bool shoot){
+    return uint8_t((dx + 1) + (dy + 1) * 3 + (shoot ? 9 : 0));
+}
+
+inline int actionDx(uint8_t a){
+    return a % 3 - 1;
+}
+
+inline int actionDy(uint8_t a){
+    return a / 3 % 3 - 1;
+}
+
+inline bool actionShoots(uint8_t a){
+    return a >= 9;
+}
+
+struct GameState {
+    static const int MaxTanks = 4;
+    static const int MaxBulletsPerTank = 16; // upper bound of MatchConfig::maxBullets
+    static const int MaxBullets = MaxTanks * MaxBulletsPerTank; // every live bullet fits, a snapshot never drops one
+    int8_t bulletSpeed; // cells per tick of new bullets
+    int8_t fireInterval; // ticks between two shots, same as MatchConfig::fireInterval
+    int8_t maxPerTank; // live bullets per tank, same as MatchConfig::maxBullets
+    int16_t thinkTicks; // ticks between two decisions of a tank, same as MatchConfig::thinkTicks
+
+    const WallGrid* walls;
+    int tick;
+    int8_t tankCount;
+    int8_t bulletCount;
+    SimTank tanks[MaxTanks];
+    SimBullet bullets[MaxBullets];
+
+    bool blocked(int x, int y) const{
+        if(x < 1 || y < 1 || x >= walls->width - 1 || y >= walls->height - 1)
+            return true;
+        return walls->cells[y * walls->width + x] != 0;
+    }
+
+    int tankAt(int x, int y) const{
+        for(int i = 0; i < tankCount; ++i)
+            if(tanks[i].health > 0 && tanks[i].x == x && tanks[i].y == y) return i;
+        return -1;
+    }
+
+    int aliveCount() const{
+        int n = 0;
+        for(int i = 0; i < tankCount; ++i)
+            if(tanks[i].health > 0) n++;
+        return n;
+    }
+
+    bool finished() const{
+        return aliveCount() <= 1;
+    }
+
+    // one step of tank i, same rules as Tank::move: the direction turns even when the cell is taken
+    void move(int i, int dx, int dy){
+        SimTank& t = tanks[i];
+        int nx = t.x + dx, ny = t.y + dy;
+        t.direction = dx == -1 ? 'a' : dx == 1 ? 'd' : dy == -1 ? 'w' : 's';
+        if(!blocked(nx, ny) && tankAt(nx, ny) < 0){
+            t.x = nx;
+            t.y = ny;
+        }
+    }
+
+    // same limits as BulletSystem::spawn
+    void shoot(int i){
+        SimTank& t = tanks[i];
+        if(t.cooldown > 0 || t.bullets >= maxPerTank || bulletCount >= MaxBullets)
+            return;
+        SimBullet& b = bullets[bulletCount++];
+        b.x = t.x;
+        b.y = t.y;
+        b.dx = t.direction == 'a' ? -bulletSpeed : t.direction == 'd' ? bulletSpeed : 0;
+        b.dy = t.direction == 'w' ? -bulletSpeed : t.direction == 's' ? bulletSpeed : 0;
+        b.owner = i;
+        t.bullets++;
+        t.cooldown = fireInterval;
+    }
+
+    // carry out one decision of tank i in the order Match::think does
+    void act(int i, uint8_t a){
+        if(actionDx(a)) move(i, actionDx(a), 0);
+        if(actionDy(a)) move(i, 0, actionDy(a));
+        if(actionShoots(a)) shoot(i);
+    }
+
+    // the decision Match::think would make for tank i: chase the nearest enemy or take a random step, shoot when close
+    template<typename Gen>
+    uint8_t chaseAction(int i, Gen& gen) const{
+        const SimTank& t = tanks[i];
+        int target = -1, best = 0;
+        for(int j = 0; j < tankCount; ++j){
+            if(j == i || tanks[j].health <= 0) continue;
+            int d = std::abs(tanks[j].x - t.x) + std::abs(tanks[j].y - t.y);
+            if(target < 0 || d < best){
+                target = j;
+                best = d;
+            }
+        }
+        if(target < 0) return ACT_STAY;
+
+        int dx = tanks[target].x - t.x;
+        int dy = tanks[target].y - t.y;
+        bool shoot = std::abs(dx) <= 15 && std::abs(dy) <= 15;
+        if(gen() % 4 == 0){
+            static const int dirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            int d = gen() % 4;
+            return makeAction(dirs[d][0], dirs[d][1], shoot);
+        }
+        return makeAction((dx > 0) - (dx < 0), (dy > 0) - (dy < 0), shoot);
+    }
+
+    // advance one tick after the due decisions were made, same order as Match::step: bullets move, then the clock
+    void step(){
+        tick++;
+        int n = bulletCount;
+        int i = 0;
+        while(i < n){
+            SimBullet& b = bullets[i];
+            // sweep the traversed cells like BulletSystem::step
+            const int steps = std::max(std::abs(b.dx), std::abs(b.dy));
+            const int sx = b.x, sy = b.y;
+            bool dead = false;
+            for(int s = 1; s <= steps && !dead; ++s){
+                b.x = sx + b.dx * s / steps;
+                b.y = sy + b.dy * s / steps;
+                dead = blocked(b.x, b.y);
+                if(!dead){
+                    int hit = tankAt(b.x, b.y);
+                    if(hit >= 0 && hit != b.owner){
+                        tanks[hit].health--;
+                        dead = true;
+                    }
+                }
+            }
+            if(dead){
+                tanks[b.owner].bullets--;
+                bullets[i] = bullets[--n];
+            }
+            else ++i;
+        }
+        bulletCount = n;
+
+        for(int j = 0; j < tankCount; ++j){
+            if(tanks[j].cooldown > 0) tanks[j].cooldown--;
+            if(tanks[j].nextThink > 0) tanks[j].nextThink--;
+        }
+    }
+
+    // tanks[me] health minus the enemies' health, with a bonus for winning
+    int score(int me) const{
+        int s = tanks[me].health * 10;
+        for(int i = 0; i < tankCount; ++i)
+            if(i != me) s -= std::max<int>(tanks[i].health, 0) * 10;
+        if(tanks[me].health <= 0) s -= 1000;
+        else if(finished()) s += 1000;
+        return s;
+    }
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must stay trivially copyable");
+
+// Monte Carlo lookahead: try every decision for one tank and play rollouts after it, where every tank plays the chase ai
+class MonteCarloPlanner {
+private:
+    int rollouts; // per action
+    int depth; // decisions of the planning tank per rollout
+
+    long long evaluate(const GameState& root, int me, uint8_t first, int n, std::mt19937& gen) const{
+        long long total = 0;
+        const int ticks = depth * std::max<int>(root.thinkTicks, 1);
+        for(int r = 0; r < n; ++r){
+            GameState s = root; // clone
+            bool firstDone = false;
+            for(int d = 0; d < ticks && !s.finished() && s.tanks[me].health > 0; ++d){
+                // tanks only act when their think interval is up, like the timer wheel in Match
+                for(int i = 0; i < s.tankCount; ++i){
+                    SimTank& t = s.tanks[i];
+                    if(t.health <= 0 || t.nextThink > 0) continue;
+                    uint8_t a = i == me && !firstDone ? first : s.chaseAction(i, gen);
+                    if(i == me) firstDone = true;
+                    s.act(i, a);
+                    t.nextThink = s.thinkTicks;
+                }
+                s.step();
+            }
+            total += s.score(me);
+        }
+        return total;
+    }
+
+public:
+    MonteCarloPlanner(int rolloutsPerAction = 16, int rolloutDepth = 4) :
+        rollouts(rolloutsPerAction), depth(rolloutDepth){}
+
+    int rolloutsPerDecision() const{
+        return rollouts * ACT_COUNT;
+    }
+
+    int getDepth() const{
+        return depth;
+    }
+
+    // the root must be taken when tanks[me] is about to decide, i.e. tanks[me].nextThink == 0
+    uint8_t chooseAction(const GameState& s, int me, unsigned seed) const{
+        std::mt19937 gen(seed);
+        uint8_t best = ACT_STAY;
+        long long bestScore = 0;
+        for(uint8_t a = 0; a < ACT_COUNT; ++a){
+            long long score = evaluate(s, me, a, rollouts, gen);
+            if(a == 0 || score > bestScore){
+                best = a;
+                bestScore = score;
+            }
+        }
+        return best;
+    }
+};
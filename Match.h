@@ -0,0 +1,365 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "Objects.h"
+#include "GameState.h"
+#include "Arena.h"
+#include "TimerWheel.h"
+
+// settings of one headless AI-only match
+struct MatchConfig {
+    int width = 60;
+    int height = 40;
+    int aiTanks = 3; // opponents of tank 0, tank 0 is also ai controlled
+    int health = 1;
+    int maxTicks = 5000; // draw after this many ticks
+    int thinkTicks = 12; // ai decision interval, 12 ticks ~ 700 ms of the interactive game
+    int lookahead = 0; // rollouts per action for tank 0, 0 = plain chase ai
+    int bulletSpeed = 1; // cells per tick
+    int fireInterval = 4; // ticks between two shots of a tank
+    int maxBullets = 3; // live bullets per tank
+    unsigned seed = 0;
+};
+
+struct MatchResult {
+    int winner = -1; // tank id, -1 = draw
+    int ticks = 0;
+    uint64_t steadyAllocs = 0; // heap allocations during ticks after the warmup, should stay 0
+};
+
+// tick driven match without window, threads or sleeps
+class Match {
+private:
+    MatchConfig cfg;
+    Arena arena; // tanks live here, released in one shot with the match
+    Map map;
+    ObjectsPool objpool;
+    std::vector<Tank*> tanks;
+    std::vector<int> hits;
+    std::vector<BulletInfo> bulletInfo;
+    std::vector<int> nextThink; // tick of each tank's next decision, mirrors the timer wheel for snapshots
+    TimerWheel timers; // ai think intervals and hit flashes
+    WallGrid walls;
+    MonteCarloPlanner planner;
+    std::mt19937 gen;
+    int tick;
+
+    Tank* nearestEnemy(Tank* self){
+        Tank* target = nullptr;
+        int best = 0;
+        for(auto const& t:tanks){
+            if(t == self || !t->is_alive()) continue;
+            int d = abs(t->getX() - self->getX()) + abs(t->getY() - self->getY());
+            if(!target || d < best){
+                target = t;
+                best = d;
+            }
+        }
+        return target;
+    }
+
+    // let the planner pick tank 0's next decision from a snapshot of the match
+    void thinkLookahead(Tank* t){
+        GameState s;
+        snapshot(s);
+        uint8_t a = planner.chooseAction(s, t->getId(), gen());
+        if(actionDx(a)) t->move(actionDx(a), 0, map);
+        if(actionDy(a)) t->move(0, actionDy(a), map);
+        if(actionShoots(a))
+            objpool.getBullets().spawn(t->getX(), t->getY(), t->getId(), t->getDirection());
+    }
+
+    // same chase & shoot behaviour as aiTankThink, with a random step to get around walls
+    void think(Tank* t){
+        Tank* target = nearestEnemy(t);
+        if(!target) return;
+
+        int dx = target->getX() - t->getX();
+        int dy = target->getY() - t->getY();
+
+        if(gen() % 4 == 0){
+            static const int dirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            int d = gen() % 4;
+            t->move(dirs[d][0], dirs[d][1], map);
+        }
+        else{
+            if(dx < 0) t->move(-1, 0, map); // left
+            else if (dx > 0) t->move(1, 0, map); // right
+
+            if(dy < 0) t->move(0, -1, map); // up
+            else if (dy > 0) t->move(0, 1, map); // down
+        }
+
+        // attack
+        if (abs(dx) <= 15 && abs(dy) <= 15)
+            objpool.getBullets().spawn(t->getX(), t->getY(), t->getId(), t->getDirection());
+    }
+
+    // one ai decision, then schedule the next one
+    void onThink(Tank* t){
+        if(!t->is_alive()) return;
+        if(t->getId() == 0 && cfg.lookahead > 0) thinkLookahead(t);
+        else think(t);
+        nextThink[t->getId()] = tick + cfg.thinkTicks;
+        timers.schedule(cfg.thinkTicks, [this, t]() { onThink(t); });
+    }
+
+public:
+    Match(const MatchConfig& config) :
+        cfg(config), arena(4096), map(config.width, config.height, config.seed), objpool(&arena),
+        planner(std::max(config.lookahead, 1)), gen(config.seed), tick(0){
+        map.addObstacle();
+        objpool.createTank(map, cfg.aiTanks, cfg.health);
+        objpool.getBullets().setSpeed(cfg.bulletSpeed);
+        objpool.getBullets().setFireRate(cfg.fireInterval);
+        objpool.getBullets().setMaxPerOwner(cfg.maxBullets);
+        objpool.getBullets().reserve(std::max(64, cfg.maxBullets * 4), cfg.width * cfg.height);
+        tanks = objpool.getTankPool();
+        walls.load(map);
+        hits.reserve(std::max(64, cfg.maxBullets * 4));
+        bulletInfo.reserve(std::max(64, cfg.maxBullets * 4));
+
+        // stagger the tanks so they do not all think on the same tick
+        nextThink.resize(tanks.size());
+        for(auto const& t:tanks){
+            int first = (cfg.thinkTicks - t->getId() * 3 % cfg.thinkTicks) % cfg.thinkTicks;
+            nextThink[t->getId()] = first;
+            timers.schedule(first + 1, [this, t]() { onThink(t); });
+        }
+    }
+
+    // copy the live match into a compact state, walls are shared with every clone
+    void snapshot(GameState& s){
+        std::memset(&s, 0, sizeof(s));
+        s.walls = &walls;
+        s.tick = tick;
+        s.tankCount = (int8_t)tanks.size();
+        s.bulletSpeed = (int8_t)std::min(cfg.bulletSpeed, 127);
+        s.thinkTicks = (int16_t)std::min(cfg.thinkTicks, 32767);
+        s.fireInterval = (int8_t)std::min(cfg.fireInterval, 127);
+        s.maxPerTank = (int8_t)std::min(cfg.maxBullets, (int)GameState::MaxBulletsPerTank);
+        BulletSystem& bullets = objpool.getBullets();
+        for(size_t i = 0; i < tanks.size(); ++i){
+            SimTank& st = s.tanks[i];
+            st.x = tanks[i]->getX();
+            st.y = tanks[i]->getY();
+            st.health = tanks[i]->getHealth();
+            st.direction = tanks[i]->getDirection();
+            st.cooldown = bullets.getCooldown(i);
+            st.nextThink = (int16_t)std::max(nextThink[i] - tick, 0);
+        }
+        bullets.getBulletInfo(bulletInfo);
+        for(auto const& b:bulletInfo){
+            if(s.bulletCount == GameState::MaxBullets) break;
+            s.bullets[s.bulletCount++] = {(int16_t)b.x, (int16_t)b.y, (int8_t)b.dx, (int8_t)b.dy, (int8_t)b.owner, 0};
+            s.tanks[b.owner].bullets++; // count what was copied, a rollout frees exactly these
+        }
+    }
+
+    int aliveCount() const{
+        int n = 0;
+        for(auto const& t:tanks)
+            if(t->is_alive()) n++;
+        return n;
+    }
+
+    int getTick() const{
+        return tick;
+    }
+
+    // draw the current tick, bullets and tanks at their settled cells
+    void display(SDL_Renderer* renderer){
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        map.display(renderer);
+        objpool.getBullets().display(renderer);
+        for(auto const& t:tanks)
+            t->display(renderer);
+    }
+
+    // advance one tick, return false when the match is over
+    bool step(){
+        if(aliveCount() <= 1 || tick >= cfg.maxTicks)
+            return false;
+
+        timers.advance();
+
+        hits.clear();
+        objpool.getBullets().step(map, hits);
+        for(int id : hits){
+            Tank* t = tanks[id];
+            if(t->is_alive()){
+                t->takeDamage(map);
+                timers.schedule(HIT_FLASH_TICKS, [t]() { t->endFlash(); });
+            }
+        }
+        tick++;
+        return true;
+    }
+
+    MatchResult run(){
+        // the first ticks size the reusable buffers, after that a tick must not touch the heap
+        const int warmup = 16;
+        while(tick < warmup && step()){}
+        uint64_t before = AllocStats::threadAllocations();
+        while(step()){}
+
+        MatchResult result;
+        result.steadyAllocs = AllocStats::threadAllocations() - before;
+        result.ticks = tick;
+        if(aliveCount() == 1){
+            for(auto const& t:tanks)
+                if(t->is_alive()) result.winner = t->getId();
+        }
+        return result;
+    }
+};
+
+struct TournamentConfig {
+    int matches = 1000;
+    int threads = 0; // 0 = one per core
+    MatchConfig match;
+    std::string out = "tournament.csv";
+};
+
+// run many headless matches concurrently, one match per pool worker, and append the aggregate to a csv
+inline bool runTournament(const TournamentConfig& cfg){
+    int threads = cfg.threads > 0 ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+    int tankCount = cfg.match.aiTanks + 1;
+    std::string header = "matches,threads,width,height,ai_tanks,health,max_ticks,lookahead,bullet_speed,fire_interval,max_bullets,seed,draw_rate";
+    for(int i = 0; i < 4; ++i) header += ",win_rate_tank" + std::to_string(i);
+    header += ",avg_ticks,min_ticks,max_ticks,elapsed_s,matches_per_sec";
+
+    bool newFile;
+    {
+        std::ifstream check(cfg.out);
+        std::string first;
+        newFile = !check.good() || !std::getline(check, first) || first.empty();
+        // rows are only comparable under the same columns, never append to a file of another layout
+        if(!newFile && first != header){
+            std::cerr << "[ERROR] " << cfg.out << " has different columns, write to a new file with --out" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<MatchResult> results(cfg.matches);
+    std::atomic<int> next(0);
+    const unsigned baseSeed = cfg.match.seed ? cfg.match.seed : 0x9e3779b9u;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for(int w = 0; w < threads; ++w){
+            pool.enqueue([&]() {
+                int i;
+                while((i = next++) < cfg.matches){
+                    MatchConfig mc = cfg.match;
+                    // every match gets its own reproducible seed
+                    mc.seed = baseSeed + i * 2654435761u;
+                    if(mc.seed == 0) mc.seed = 1;
+                    Match m(mc);
+                    results[i] = m.run();
+                }
+            });
+        }
+    } // pool joins here
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> wins(tankCount, 0);
+    int draws = 0;
+    long long totalTicks = 0;
+    uint64_t steadyAllocs = 0;
+    int minTicks = cfg.matches ? results[0].ticks : 0, maxTicks = 0;
+    for(auto const& r:results){
+        if(r.winner < 0) draws++;
+        else wins[r.winner]++;
+        totalTicks += r.ticks;
+        steadyAllocs += r.steadyAllocs;
+        minTicks = std::min(minTicks, r.ticks);
+        maxTicks = std::max(maxTicks, r.ticks);
+    }
+    double n = std::max(cfg.matches, 1);
+
+    std::ofstream csv(cfg.out, std::ios::app);
+    if(!csv){
+        std::cerr << "[ERROR] Failed to open " << cfg.out << std::endl;
+        return false;
+    }
+    if(newFile)
+        csv << header << "\n";
+    csv << cfg.matches << "," << threads << "," << cfg.match.width << "," << cfg.match.height << ","
+        << cfg.match.aiTanks << "," << cfg.match.health << "," << cfg.match.maxTicks << ","
+        << cfg.match.lookahead << "," << cfg.match.bulletSpeed << "," << cfg.match.fireInterval << ","
+        << cfg.match.maxBullets << "," << baseSeed << "," << draws / n;
+    for(int i = 0; i < 4; ++i) csv << "," << (i < tankCount ? wins[i] / n : 0.0);
+    csv << "," << totalTicks / n << "," << minTicks << "," << maxTicks << ","
+        << elapsed << "," << cfg.matches / std::max(elapsed, 1e-9) << "\n";
+
+    std::cout << cfg.matches << " matches on " << threads << " threads in " << elapsed << " s ("
+              << cfg.matches / std::max(elapsed, 1e-9) << " matches/sec)" << std::endl;
+    for(int i = 0; i < tankCount; ++i)
+        std::cout << "Tank " << i << " win rate: " << wins[i] / n << std::endl;
+    std::cout << "Draw rate: " << draws / n << ", avg match length: " << totalTicks / n << " ticks" << std::endl;
+    std::cout << "Heap allocations in steady-state ticks: " << steadyAllocs << std::endl;
+    return true;
+}
+
+// measure how fast the lookahead state can be cloned and rolled out
+inline void runCloneBenchmark(double seconds, int threads){
+    threads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    MatchConfig mc;
+    mc.seed = 12345;
+    Match m(mc);
+    for(int i = 0; i < 100; ++i) m.step(); // get some bullets flying
+    GameState root;
+    m.snapshot(root);
+
+    // clones/sec, single thread
+    std::vector<GameState> copies(1024);
+    std::atomic<int> sink(0); // keeps the clones and the search from being optimized away
+    long long clones = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration<double>(seconds / 2);
+    while(std::chrono::steady_clock::now() < end){
+        for(auto& c:copies){
+            c = root;
+            c.tick += (int)clones; // keep the copy observable
+        }
+        clones += copies.size();
+        sink += copies[clones % copies.size()].tick;
+    }
+    double cloneTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // rollouts/sec, one planner per thread
+    MonteCarloPlanner planner(16, 4);
+    std::atomic<long long> rollouts(0);
+    std::atomic<bool> running(true);
+    start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for(int w = 0; w < threads; ++w){
+            pool.enqueue([&, w]() {
+                unsigned seed = w;
+                int picked = 0;
+                while(running){
+                    picked += planner.chooseAction(root, 0, seed++);
+                    rollouts += planner.rolloutsPerDecision();
+                }
+                sink += picked;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+        running = false;
+    }
+    double rolloutTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "GameState size: " << sizeof(GameState) << " bytes" << std::endl;
+    std::cout << "State clones/sec: " << clones / cloneTime << " (1 thread)" << std::endl;
+    std::cout << "Rollouts/sec: " << rollouts / rolloutTime << " (" << threads << " threads, depth " << planner.getDepth() << " decisions)" << std::endl;
+}
@@ -0,0 +1,360 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// all updates are relaxed atomics, cheap enough for the game loops
+
+class Counter {
+private:
+    std::atomic<uint64_t> value{0};
+
+public:
+    void inc(uint64_t n = 1) {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+class Gauge {
+private:
+    std::atomic<int64_t> value{0};
+
+public:
+    void set(int64_t v) {
+        value.store(v, std::memory_order_relaxed);
+    }
+    void add(int64_t n) {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+    int64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+class Histogram {
+private:
+    std::vector<double> bounds; // upper bounds, ascending
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets; // one per bound, the last slot is +Inf
+    std::atomic<uint64_t> count{0};
+    std::atomic<double> sum{0};
+
+public:
+    Histogram(const std::vector<double>& upperBounds) :
+        bounds(upperBounds), buckets(new std::atomic<uint64_t>[upperBounds.size() + 1]) {
+        for (size_t i = 0; i <= bounds.size(); ++i)
+            buckets[i] = 0;
+    }
+
+    void observe(double v) {
+        size_t i = 0;
+        while (i < bounds.size() && v > bounds[i]) ++i;
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        double old = sum.load(std::memory_order_relaxed);
+        while (!sum.compare_exchange_weak(old, old + v, std::memory_order_relaxed)) {}
+    }
+
+    // prometheus text for this histogram, buckets are cumulative
+    void write(std::ostream& out, const std::string& name) const {
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < bounds.size(); ++i) {
+            cumulative += buckets[i].load(std::memory_order_relaxed);
+            out << name << "_bucket{le=\"" << bounds[i] << "\"} " << cumulative << "\n";
+        }
+        cumulative += buckets[bounds.size()].load(std::memory_order_relaxed);
+        out << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+        out << name << "_sum " << sum.load(std::memory_order_relaxed) << "\n";
+        out << name << "_count " << count.load(std::memory_order_relaxed) << "\n";
+    }
+};
+
+class MetricsRegistry {
+private:
+    struct Entry {
+        std::string name, help, type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::mutex mtx;
+
+    Entry* find(const std::string& name) {
+        for (auto& e : entries)
+            if (e->name == name) return e.get();
+        return nullptr;
+    }
+
+    Entry* add(const std::string& name, const std::string& help, const std::string& type) {
+        entries.emplace_back(new Entry{name, help, type, nullptr, nullptr, nullptr});
+        return entries.back().get();
+    }
+
+    MetricsRegistry() {}
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+public:
+    static MetricsRegistry& getInstance() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+
+    // registration takes a lock, keep the returned reference instead of looking it up on a hot path
+    Counter& counter(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Entry* e = find(name);
+        if (!e) {
+            e = add(name, help, "counter");
+            e->counter.reset(new Counter());
+        }
+        return *e->counter;
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Entry* e = find(name);
+        if (!e) {
+            e = add(name, help, "gauge");
+            e->gauge.reset(new Gauge());
+        }
+        return *e->gauge;
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Entry* e = find(name);
+        if (!e) {
+            e = add(name, help, "histogram");
+            e->histogram.reset(new Histogram(bounds));
+        }
+        return *e->histogram;
+    }
+
+    // everything in prometheus text exposition format
+    std::string render() {
+        std::ostringstream out;
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto& e : entries) {
+            out << "# HELP " << e->name << " " << e->help << "\n";
+            out << "# TYPE " << e->name << " " << e->type << "\n";
+            if (e->counter) out << e->name << " " << e->counter->get() << "\n";
+            else if (e->gauge) out << e->name << " " << e->gauge->get() << "\n";
+            else if (e->histogram) e->histogram->write(out, e->name);
+        }
+        return out.str();
+    }
+};
+
+// the game's metrics, registered once on first use
+struct GameMetrics {
+    Counter& ticks;
+    Counter& tankMoves;
+    Counter& lockWaits;
+    Histogram& lockWaitSeconds;
+    Histogram& frameSeconds;
+    Gauge& liveBullets;
+    Gauge& poolQueueDepth;
+
+    static GameMetrics& get() {
+        static GameMetrics m;
+        return m;
+    }
+
+private:
+    GameMetrics() :
+        ticks(MetricsRegistry::getInstance().counter("tank_ticks_total", "Simulation ticks.")),
+        tankMoves(MetricsRegistry::getInstance().counter("tank_moves_total", "Successful tank moves.")),
+        lockWaits(MetricsRegistry::getInstance().counter("tank_map_lock_waits_total", "Map lock acquisitions that had to wait.")),
+        lockWaitSeconds(MetricsRegistry::getInstance().histogram("tank_map_lock_wait_seconds", "Time spent waiting for a contended map lock.",
+            {1e-6, 1e-5, 1e-4, 1e-3, 1e-2})),
+        frameSeconds(MetricsRegistry::getInstance().histogram("tank_frame_seconds", "Render frame time.",
+            {0.004, 0.008, 0.0125, 0.017, 0.025, 0.033, 0.05, 0.1})),
+        liveBullets(MetricsRegistry::getInstance().gauge("tank_live_bullets", "Bullets in flight.")),
+        poolQueueDepth(MetricsRegistry::getInstance().gauge("tank_pool_queue_depth", "Tasks waiting in the game thread pool.")) {}
+};
+
+// lock_guard that records how long a contended lock took, the uncontended path is a single try_lock
+class MeteredLock {
+private:
+    std::mutex& m;
+
+public:
+    MeteredLock(std::mutex& mtx) : m(mtx) {
+        if (m.try_lock()) return;
+        auto start = std::chrono::steady_clock::now();
+        m.lock();
+        GameMetrics& metrics = GameMetrics::get();
+        metrics.lockWaits.inc();
+        metrics.lockWaitSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    ~MeteredLock() {
+        m.unlock();
+    }
+    MeteredLock(const MeteredLock&) = delete;
+    MeteredLock& operator=(const MeteredLock&) = delete;
+};
+
+/*
+    Serves MetricsRegistry::render() over HTTP on a unix socket or a loopback port.
+    Runs on its own idle priority thread and only touches the atomics when scraped.
+*/
+class MetricsServer {
+private:
+    int fd;
+    std::string socketPath;
+    dev_t socketDev = 0;
+    ino_t socketIno = 0;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    void serve() {
+        // stay out of the game's way
+        sched_param param{};
+        if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+            setpriority(PRIO_PROCESS, 0, 19);
+
+        while (running) {
+            pollfd p{fd, POLLIN, 0};
+            if (poll(&p, 1, 200) <= 0) continue;
+            int client = accept(fd, nullptr, nullptr);
+            if (client < 0) continue;
+
+            // read whatever request came in, the reply is always the full metrics page
+            pollfd c{client, POLLIN, 0};
+            char buf[1024];
+            if (poll(&c, 1, 100) > 0) {
+                ssize_t n = read(client, buf, sizeof(buf));
+                (void)n;
+            }
+            std::string body = MetricsRegistry::getInstance().render();
+            std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            size_t sent = 0;
+            while (sent < response.size()) {
+                // a client that already hung up (e.g. a liveness probe) must not SIGPIPE the game
+                ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                sent += n;
+            }
+            close(client);
+        }
+    }
+
+public:
+    MetricsServer() : fd(-1), running(false) {}
+
+    ~MetricsServer() {
+        stop();
+    }
+
+    bool startUnix(const std::string& path) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "[ERROR] Metrics socket path too long: " << path << std::endl;
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        // only clear out a stale socket from an earlier run, never anything else
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                std::cerr << "[ERROR] Metrics socket path exists and is not a socket: " << path << std::endl;
+                close(fd);
+                fd = -1;
+                return false;
+            }
+            // a socket someone still accepts on belongs to another instance, only a refused one is stale
+            int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+            bool stale = false;
+            if (probe >= 0) {
+                stale = connect(probe, (sockaddr*)&addr, sizeof(addr)) < 0 && errno == ECONNREFUSED;
+                close(probe);
+            }
+            if (!stale) {
+                std::cerr << "[ERROR] Metrics socket " << path << " is in use by another process" << std::endl;
+                close(fd);
+                fd = -1;
+                return false;
+            }
+            unlink(path.c_str());
+        }
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+            std::cerr << "[ERROR] Failed to listen on " << path << ": " << strerror(errno) << std::endl;
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        // remember what we bound so stop() only removes our own socket
+        if (lstat(path.c_str(), &st) == 0) {
+            socketPath = path;
+            socketDev = st.st_dev;
+            socketIno = st.st_ino;
+        }
+        running = true;
+        worker = std::thread([this] { serve(); });
+        return true;
+    }
+
+    bool startTcp(int port) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+            std::cerr << "[ERROR] Failed to listen on 127.0.0.1:" << port << ": " << strerror(errno) << std::endl;
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        running = true;
+        worker = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) worker.join();
+        if (fd >= 0) close(fd);
+        fd = -1;
+        if (!socketPath.empty()) {
+            struct stat st;
+            if (lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)
+                && st.st_dev == socketDev && st.st_ino == socketIno) {
+                unlink(socketPath.c_str());
+            }
+        }
+        socketPath.clear();
+    }
+};
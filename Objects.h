@@ -1,3 +1,4 @@
+#pragma once
 #include <vector>
 #include <iostream>
 #include <mutex>
@@ -10,7 +11,11 @@
 #include <stdio.h>
 #include <queue>
 #include <functional>
+#include <condition_variable>
 #include <atomic>
+#include <algorithm>
+#include "Metrics.h"
+#include "Arena.h"
 
 class ThreadPool {
 private:
@@ -18,10 +23,13 @@ private:
     std::queue<std::function<void()>> tasks;
     std::mutex queueMutex;
     std::condition_variable condition;
+    std::condition_variable idleCondition;
     std::atomic<bool> stop;
+    int active; // tasks currently running, guarded by queueMutex
+    Gauge* depthGauge; // optional queue depth metric
 
 public:
-    ThreadPool(size_t threads) : stop(false) {
+    ThreadPool(size_t threads) : stop(false), active(0), depthGauge(nullptr) {
         for (size_t i = 0; i < threads; ++i) {
             workers.emplace_back([this] {
                 while (true) {
@@ -33,8 +41,16 @@ public:
                             return;
                         task = std::move(this->tasks.front());
                         this->tasks.pop();
+                        this->active++;
+                        if (this->depthGauge) this->depthGauge->set(this->tasks.size());
                     }
                     task();
+                    {
+                        std::unique_lock<std::mutex> lock(this->queueMutex);
+                        this->active--;
+                        if (this->active == 0 && this->tasks.empty())
+                            this->idleCondition.notify_all();
+                    }
                 }
             });
         }
@@ -54,9 +70,65 @@ public:
         {
             std::unique_lock<std::mutex> lock(queueMutex);
             tasks.emplace(task);
+            if (depthGauge) depthGauge->set(tasks.size());
         }
         condition.notify_one();
     }
+
+    void setQueueGauge(Gauge* gauge) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        depthGauge = gauge;
+    }
+
+    // block until the queue is empty and no task is running
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        idleCondition.wait(lock, [this] { return this->tasks.empty() && this->active == 0; });
+    }
+};
+
+// cooperative cancellation, waits wake up as soon as a stop is requested instead of sleeping it out
+class StopToken {
+private:
+    std::atomic<bool> stopped;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+public:
+    StopToken() : stopped(false) {}
+
+    void requestStop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopped = true;
+        }
+        cv.notify_all();
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopped = false;
+    }
+
+    bool stopRequested() const {
+        return stopped;
+    }
+
+    // sleep until the deadline, return false if stopped before it
+    bool waitUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mtx);
+        return !cv.wait_until(lock, deadline, [this] { return this->stopped.load(); });
+    }
+
+    bool waitFor(std::chrono::steady_clock::duration d) {
+        return waitUntil(std::chrono::steady_clock::now() + d);
+    }
+
+    // block until a stop is requested
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return this->stopped.load(); });
+    }
 };
 
 class Map {
@@ -80,19 +152,29 @@ public:
                     1 = wall
                     2 = player tank
                     3~5 = ai tank
-                    6 = bullet
+                    bullets are not stored in the grid (see BulletSystem)
     */
     
-    Map(int w, int h) : width(w), height(h){
+    // seed 0 picks a random seed, a fixed seed makes the obstacle layout reproducible
+    Map(int w, int h, unsigned seed = 0) : width(w), height(h){
         max_Obstacle_nums = (width - 1) * (height - 1) / 15;
         min_Obstacle_nums = (width - 1) * (height - 1) / 30;
-        gen.seed(rd());
+        gen.seed(seed ? seed : rd());
         distObstacles = std::uniform_int_distribution<>(min_Obstacle_nums, max_Obstacle_nums);
         distX = std::uniform_int_distribution<>(1, width - 2);
         distY = std::uniform_int_distribution<>(1, height - 2);
 
         // initialize map
         grid = std::vector<std::vector<std::pair<char, int>>>(height, std::vector<std::pair<char, int>>(width, {path, 0}));
+        reset();
+    }
+
+    // clear the map back to its boundary walls in place, the grid keeps its allocation
+    void reset() {
+        MeteredLock lock(mapMtx);
+        for (auto& row : grid) {
+            std::fill(row.begin(), row.end(), std::make_pair(path, 0));
+        }
 
         // setting boundary
         for (int i = 0; i < height; ++i) {
@@ -103,15 +185,13 @@ public:
             grid[0][j] = {wall, 0};          // up
             grid[height - 1][j] = {wall, 0}; // down
         }
-
-        
     }
 
 
     // randomly add obstacle to map
     void addObstacle() {
         int Obstacle_nums = distObstacles(gen);
-        std::lock_guard<std::mutex> lock(mapMtx); 
+        MeteredLock lock(mapMtx); 
         for(int i = 0; i < Obstacle_nums; ++i){
             int x = distX(gen);
             int y = distY(gen);
@@ -122,8 +202,9 @@ public:
         
     }
 
+    // walls only, tanks and bullets draw themselves at their interpolated positions
     void display(SDL_Renderer* renderer) {
-        
+        MeteredLock lock(mapMtx);
         for (int i = 0; i < height; ++i) {
             for (int j = 0; j < width; ++j) {
                 if (grid[i][j].first == wall) {
@@ -131,37 +212,6 @@ public:
                     SDL_Rect wallRect = {j * 20, i * 20, 20, 20}; // 20x20 pixel
                     SDL_RenderFillRect(renderer, &wallRect);
                 }
-                else if(grid[i][j].first == '*'){
-                    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // red bullet
-                    SDL_Rect bulletRect = {j * 20 + 5, i * 20 + 5, 5, 5}; // 10x10 pixel
-                    SDL_RenderFillRect(renderer, &bulletRect);
-                }
-                else if(grid[i][j].first == path){
-                    continue;
-                }
-                else if (grid[i][j].first == '^' || grid[i][j].first == 'v' || grid[i][j].first == '<' || grid[i][j].first == '>') {
-                    // Tank body
-                    if(grid[i][j].second == 2)
-                        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green for player
-                    else
-                        SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255); // blue for ai
-
-                    SDL_Rect body = {j * 20 + 4, i * 20 + 4, 12, 12}; // Tank body (center rectangle)
-                    SDL_RenderFillRect(renderer, &body);
-
-                    // Tank turret
-                    SDL_Rect turret;
-                    if (grid[i][j].first == '^') {
-                        turret = {j * 20 + 8, i * 20, 4, 4}; // Up
-                    } else if (grid[i][j].first == 'v') {
-                        turret = {j * 20 + 8, i * 20 + 16, 4, 4}; // Down
-                    } else if (grid[i][j].first == '<') {
-                        turret = {j * 20, i * 20 + 8, 4, 4}; // Left
-                    } else if (grid[i][j].first == '>') {
-                        turret = {j * 20 + 16, i * 20 + 8, 4, 4}; // Right
-                    }
-                    SDL_RenderFillRect(renderer, &turret);
-                }
             }
         }
     }
@@ -174,17 +224,45 @@ public:
     // set objects
     void setCell(int x, int y, char value, int id) {
         if (isWithinBounds(x, y)) {
-            std::lock_guard<std::mutex> lock(mapMtx);
+            MeteredLock lock(mapMtx);
             grid[y][x] = {value, id};
         }
     }
     
+    // move an object from (oldX, oldY) to a free (newX, newY), check and set happen under one lock
+    bool tryMove(int oldX, int oldY, int newX, int newY, char value, int id) {
+        if (!isWithinBounds(newX, newY)) return false;
+        MeteredLock lock(mapMtx);
+        if (grid[newY][newX].first != path) return false;
+        if (isWithinBounds(oldX, oldY)) grid[oldY][oldX] = {path, 0};
+        grid[newY][newX] = {value, id};
+        return true;
+    }
+
+    // put an object on a free cell
+    bool tryPlace(int x, int y, char value, int id) {
+        if (!isWithinBounds(x, y)) return false;
+        MeteredLock lock(mapMtx);
+        if (grid[y][x].first != path) return false;
+        grid[y][x] = {value, id};
+        return true;
+    }
+
     // get cell
     char getCell(int x, int y){
-    	std::lock_guard<std::mutex> lock(mapMtx);
+    	MeteredLock lock(mapMtx);
     	return grid[y][x].first;
     }
 
+    // copy the whole grid row by row under a single lock
+    void copyCells(std::vector<std::pair<char, int>>& out){
+        MeteredLock lock(mapMtx);
+        out.resize(width * height);
+        for (int i = 0; i < height; ++i) {
+            std::copy(grid[i].begin(), grid[i].end(), out.begin() + i * width);
+        }
+    }
+
     int getwidth() const{ 
         return width; 
     }
@@ -193,32 +271,97 @@ public:
     }
 };
 
+const int HIT_FLASH_TICKS = 2; // ticks a hit tank blinks out, ~120 ms at the game's 60 ms tick
+
 class Tank {
 private:
-    int x, y; // tank location
-    char symbol; // symbol of tank
-    char direction; // head direction of tank
-    int health;
+    std::atomic<int> x, y; // tank location
+    std::atomic<char> symbol; // symbol of tank
+    std::atomic<char> direction; // head direction of tank
+    std::atomic<int> health;
     std::mutex mtx; // tank mutex
     int tank_id; // 2, 3, 4, 5
+    // render interpolation: previous cell and when the last move happened
+    std::atomic<int> prevX, prevY;
+    std::atomic<long long> moveTime;
+    std::atomic<bool> flashing;
+
+    // tank body and turret with the top-left corner at pixel (px, py)
+    void draw(SDL_Renderer* renderer, int px, int py){
+        // Tank body
+        if(tank_id == 0)
+            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green for player
+        else
+            SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255); // blue for ai
+
+        SDL_Rect body = {px + 4, py + 4, 12, 12}; // Tank body (center rectangle)
+        SDL_RenderFillRect(renderer, &body);
+
+        // Tank turret
+        SDL_Rect turret;
+        char s = symbol;
+        if (s == '^') {
+            turret = {px + 8, py, 4, 4}; // Up
+        } else if (s == '<') {
+            turret = {px, py + 8, 4, 4}; // Left
+        } else if (s == '>') {
+            turret = {px + 16, py + 8, 4, 4}; // Right
+        } else {
+            turret = {px + 8, py + 16, 4, 4}; // Down
+        }
+        SDL_RenderFillRect(renderer, &turret);
+    }
 
 public:
     Tank(int startX, int startY, char sym, int hp, int id):
-        x(startX), y(startY), symbol(sym), health(hp), tank_id(id), direction('s'){}
+        x(startX), y(startY), symbol(sym), direction('s'), health(hp), tank_id(id),
+        prevX(startX), prevY(startY), moveTime(0), flashing(false){}
         
      
-    void move(int dx, int dy, Map& map) {
+    // return true if the tank actually moved
+    bool move(int dx, int dy, Map& map) {
         std::lock_guard<std::mutex> lock(mtx); 
+        if (!is_alive()) return false; // a tank killed by another thread must not come back
         int newX = x + dx;
         int newY = y + dy;
         direction = (dx == -1 ? 'a' : dx == 1 ? 'd' : dy == -1 ? 'w' : 's');
         symbol = (dx == -1 ? '<' : dx == 1 ? '>' : dy == -1 ? '^' : 'v');
-        if (map.isWithinBounds(newX, newY) && map.getCell(newX, newY) == map.path) {
-            map.setCell(x, y, map.path, 0);
-            x = newX;
-            y = newY;
-            map.setCell(x, y, symbol, tank_id+2);
-        }
+        if (!map.tryMove(x, y, newX, newY, symbol, tank_id+2))
+            return false;
+        prevX = x.load();
+        prevY = y.load();
+        moveTime = std::chrono::steady_clock::now().time_since_epoch().count();
+        x = newX;
+        y = newY;
+        GameMetrics::get().tankMoves.inc();
+        return true;
+    }
+
+    // draw the tank sliding from its previous cell to the current one over slide
+    void display(SDL_Renderer* renderer, std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration slide){
+        if(!is_alive() || flashing) return;
+
+        double t = double(now.time_since_epoch().count() - moveTime) / slide.count();
+        t = std::min(std::max(t, 0.0), 1.0);
+        draw(renderer, int((prevX + (x - prevX) * t) * 20), int((prevY + (y - prevY) * t) * 20));
+    }
+
+    // draw the tank at its current cell, for callers without a clock (headless matches, recordings)
+    void display(SDL_Renderer* renderer){
+        if(!is_alive() || flashing) return;
+        draw(renderer, x * 20, y * 20);
+    }
+
+    // bring a tank back for a new match
+    void reset(int startX, int startY, char sym, int hp){
+        std::lock_guard<std::mutex> lock(mtx); 
+        x = prevX = startX;
+        y = prevY = startY;
+        symbol = sym;
+        direction = 's';
+        health = hp;
+        moveTime = 0;
+        flashing = false;
     }
 
     void setup_tank(Map& map){
@@ -257,157 +400,326 @@ public:
     int getHealth() const{
         return health;
     }
-    void takeDamage(Map& map, SDL_Renderer* renderer){
+    // take a hit and start the hit flash, the caller schedules endFlash() on its timer wheel
+    void takeDamage(Map& map){
+        applyDamage(map);
+        flashing = is_alive();
+    }
+
+    void endFlash(){
+        flashing = false;
+    }
+
+    // damage without the hit flash
+    void applyDamage(Map& map){
         std::lock_guard<std::mutex> lock(mtx); 
         health--;
 
-        map.setCell(x, y, map.path, 0);
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        map.setCell(x, y, symbol, tank_id+2);
-
         if(!is_alive()){
             map.setCell(x, y, map.path, 0);
             symbol = 'x';
         }
-        
     }
 
 };
 
-class Bullet{
-    
+struct BulletInfo {
+    int x, y, dx, dy, owner;
+};
+
+// struct-of-arrays bullet storage, all live bullets are stepped together once per tick
+class BulletSystem{
+
 private:
-    int x, y;
-    char symbol;
-    char direction;
-    int owner_id;
+    std::vector<int> x, y, dx, dy, owner; // dx, dy = velocity in cells per tick
+    std::vector<int> px, py; // position before the last step, for render interpolation
+    std::vector<char> alive; // char instead of bool, keeps the step loops vectorizable
+    std::vector<int> liveCount; // live bullets per owner
+    std::vector<int> fireInterval; // ticks between two shots per owner
+    std::vector<int> speed; // cells per tick per owner
+    std::vector<long long> nextFireTick; // earliest tick an owner may shoot again
+    std::vector<std::pair<char, int>> cells; // map snapshot for batch collision
+    std::vector<SDL_Rect> rects; // render buffer
+    int maxPerOwner;
+    long long tick;
+    std::chrono::steady_clock::time_point lastStep;
     std::mutex mtx;
-    
+
+    // caller holds mtx, alpha = fraction of the tick elapsed since the last step
+    void draw(SDL_Renderer* renderer, float alpha){
+        rects.clear();
+        for(size_t i = 0; i < x.size(); ++i){
+            int rx = int((px[i] + (x[i] - px[i]) * alpha) * 20);
+            int ry = int((py[i] + (y[i] - py[i]) * alpha) * 20);
+            rects.push_back({rx + 5, ry + 5, 5, 5}); // 5x5 pixel
+        }
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // red bullet
+        SDL_RenderFillRects(renderer, rects.data(), (int)rects.size());
+    }
+
 public:
-    Bullet(int x, int y, int owner_id, int direction){
-        this->owner_id = owner_id;
-        this->x = x;
-        this->y = y;
-        this->direction = direction;
-        symbol = '*';
+    BulletSystem(int owners = 4, int interval = 4, int maxBullets = 3):
+        liveCount(owners, 0), fireInterval(owners, interval), speed(owners, 1), nextFireTick(owners, 0),
+        maxPerOwner(maxBullets), tick(0), lastStep(std::chrono::steady_clock::now()){}
+
+    // ticks between two shots of the owner
+    void setFireRate(int owner_id, int interval){
+        std::lock_guard<std::mutex> lock(mtx);
+        if(owner_id >= 0 && owner_id < (int)fireInterval.size())
+            fireInterval[owner_id] = std::max(interval, 1);
     }
 
-    bool collision(std::vector<Tank*> tanks, Map& map, SDL_Renderer* renderer){
+    void setFireRate(int interval){
         std::lock_guard<std::mutex> lock(mtx);
-        for(auto const& t:tanks){
-            if(t->getId() != owner_id && t->is_alive() && t->getX() == x && t->getY() == y){
-                t->takeDamage(map, renderer);
-                return false;
-            }
-                
-        }
+        std::fill(fireInterval.begin(), fireInterval.end(), std::max(interval, 1));
+    }
+
+    // cells per tick of the owner's bullets, any speed is hit-tested over every cell it passes
+    void setSpeed(int owner_id, int cells){
+        std::lock_guard<std::mutex> lock(mtx);
+        if(owner_id >= 0 && owner_id < (int)speed.size())
+            speed[owner_id] = std::max(cells, 1);
+    }
+
+    void setSpeed(int cells){
+        std::lock_guard<std::mutex> lock(mtx);
+        std::fill(speed.begin(), speed.end(), std::max(cells, 1));
+    }
+
+    void setMaxPerOwner(int maxBullets){
+        std::lock_guard<std::mutex> lock(mtx);
+        maxPerOwner = std::max(maxBullets, 1);
+    }
+
+    // room for n bullets and the map snapshot, so a running match never grows the arrays
+    void reserve(size_t n, size_t mapCells = 0){
+        std::lock_guard<std::mutex> lock(mtx);
+        cells.reserve(mapCells);
+        x.reserve(n); y.reserve(n); dx.reserve(n); dy.reserve(n);
+        px.reserve(n); py.reserve(n); owner.reserve(n); alive.reserve(n);
+    }
+
+    // drop every bullet and cooldown, the arrays keep their capacity
+    void clear(){
+        std::lock_guard<std::mutex> lock(mtx);
+        x.clear(); y.clear(); dx.clear(); dy.clear();
+        px.clear(); py.clear(); owner.clear(); alive.clear();
+        std::fill(liveCount.begin(), liveCount.end(), 0);
+        std::fill(nextFireTick.begin(), nextFireTick.end(), 0);
+        tick = 0;
+    }
+
+    // fire a bullet from (bx, by), return false if the owner is cooling down or out of bullets
+    bool spawn(int bx, int by, int owner_id, char direction){
+        std::lock_guard<std::mutex> lock(mtx);
+        if(owner_id < 0 || owner_id >= (int)liveCount.size())
+            return false;
+        if(liveCount[owner_id] >= maxPerOwner || tick < nextFireTick[owner_id])
+            return false;
+
+        x.push_back(bx);
+        y.push_back(by);
+        px.push_back(bx);
+        py.push_back(by);
+        dx.push_back(direction == 'a' ? -speed[owner_id] : direction == 'd' ? speed[owner_id] : 0);
+        dy.push_back(direction == 'w' ? -speed[owner_id] : direction == 's' ? speed[owner_id] : 0);
+        owner.push_back(owner_id);
+        alive.push_back(1);
+        liveCount[owner_id]++;
+        nextFireTick[owner_id] = tick + fireInterval[owner_id];
         return true;
     }
-    
-    void shoot(std::vector<Tank*> tanks, Map& map, SDL_Renderer* renderer){
-        switch(direction){
-            case 'a':
-                mtx.lock();
-                x--;
-                mtx.unlock();
-                while(collision(tanks, map, renderer) && map.isWithinBounds(x, y) && map.getCell(x, y) == map.path){
-                    map.setCell(x, y, symbol, 6);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(60));
-                    map.setCell(x, y, map.path, 0);
-                    mtx.lock();
-                    x--;
-                    mtx.unlock();
-                }
-                break;
-            case 'd':
-                x++;
-                while(collision(tanks, map, renderer) && map.isWithinBounds(x, y) && map.getCell(x, y) == map.path){
-                    map.setCell(x, y, symbol, 6);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(60));
-                    map.setCell(x, y, map.path, 0);
-                    mtx.lock();
-                    x++;
-                    mtx.unlock();
+
+    // advance every bullet by its velocity, then sweep each one over the cells it crossed, hit tank ids are appended to hits
+    void step(Map& map, std::vector<int>& hits){
+        std::lock_guard<std::mutex> lock(mtx);
+        tick++;
+        lastStep = std::chrono::steady_clock::now();
+        const int n = (int)x.size();
+        if(n == 0)
+            return;
+
+        std::copy(x.begin(), x.end(), px.begin());
+        std::copy(y.begin(), y.end(), py.begin());
+        int* cx = x.data();
+        int* cy = y.data();
+        const int* pdx = dx.data();
+        const int* pdy = dy.data();
+        for(int i = 0; i < n; ++i){
+            cx[i] += pdx[i];
+            cy[i] += pdy[i];
+        }
+
+        // one map lock per tick instead of one per bullet
+        map.copyCells(cells);
+        const int width = map.getwidth();
+        for(int i = 0; i < n; ++i){
+            // walk the traversed span cell by cell so fast bullets cannot tunnel through walls or tanks
+            const int steps = std::max(std::abs(pdx[i]), std::abs(pdy[i]));
+            for(int s = 1; s <= steps; ++s){
+                int sx = px[i] + pdx[i] * s / steps;
+                int sy = py[i] + pdy[i] * s / steps;
+                if(!map.isWithinBounds(sx, sy)){
+                    alive[i] = 0;
                 }
-                break;
-            case 'w':
-                y--;
-                while(collision(tanks, map, renderer) && map.isWithinBounds(x, y) && map.getCell(x, y) == map.path){
-                    map.setCell(x, y, symbol, 6);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(60));
-                    map.setCell(x, y, map.path, 0);
-                    mtx.lock();
-                    y--;
-                    mtx.unlock();
+                else{
+                    const std::pair<char, int>& c = cells[sy * width + sx];
+                    if(c.first == map.wall){
+                        alive[i] = 0;
+                    }
+                    else if(c.second >= 2 && c.second - 2 != owner[i]){
+                        hits.push_back(c.second - 2);
+                        alive[i] = 0;
+                    }
                 }
-                break;
-            case 's':
-                y++;
-                while(collision(tanks, map, renderer) && map.isWithinBounds(x, y) && map.getCell(x, y) == map.path){
-                    map.setCell(x, y, symbol, 6);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(60));
-                    map.setCell(x, y, map.path, 0);
-                    mtx.lock();
-                    y++;
-                    mtx.unlock();
+                if(!alive[i]){
+                    cx[i] = sx;
+                    cy[i] = sy;
+                    break;
                 }
-                break;
+            }
         }
 
+        // swap-remove dead bullets to keep the arrays dense
+        int i = 0, last = n;
+        while(i < last){
+            if(alive[i]){
+                ++i;
+                continue;
+            }
+            liveCount[owner[i]]--;
+            --last;
+            x[i] = x[last]; y[i] = y[last];
+            px[i] = px[last]; py[i] = py[last];
+            dx[i] = dx[last]; dy[i] = dy[last];
+            owner[i] = owner[last]; alive[i] = alive[last];
+        }
+        x.resize(last); y.resize(last); dx.resize(last); dy.resize(last);
+        px.resize(last); py.resize(last); owner.resize(last); alive.resize(last);
+    }
+
+    // draw every bullet between its previous and current cell, alpha is read under the same lock as the positions
+    // so a step in between can never pair an old alpha with the new cells
+    void display(SDL_Renderer* renderer, std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration tickInterval){
+        std::lock_guard<std::mutex> lock(mtx);
+        float alpha = float(std::chrono::duration<double>(now - lastStep) / tickInterval);
+        draw(renderer, std::min(std::max(alpha, 0.0f), 1.0f));
+    }
 
+    // draw every bullet at its current cell
+    void display(SDL_Renderer* renderer){
+        std::lock_guard<std::mutex> lock(mtx);
+        draw(renderer, 1.0f);
     }
 
-    int getX() const{ 
-        return x; 
+    int size(){
+        std::lock_guard<std::mutex> lock(mtx);
+        return (int)x.size();
     }
-    int getY() const{
-        return y;
+
+    // copy of the live bullets and cooldowns, used by lookahead snapshots
+    void getBulletInfo(std::vector<BulletInfo>& out){
+        std::lock_guard<std::mutex> lock(mtx);
+        out.clear();
+        for(size_t i = 0; i < x.size(); ++i){
+            out.push_back({x[i], y[i], dx[i], dy[i], owner[i]});
+        }
     }
-    int getId() const{
-        return owner_id;
+
+    int getCooldown(int owner_id){
+        std::lock_guard<std::mutex> lock(mtx);
+        return (int)std::max(nextFireTick[owner_id] - tick, 0LL);
+    }
+
+    // bookkeeping errors: per owner counts that do not add up to the stored bullets or exceed the cap
+    int countLeaks(){
+        std::lock_guard<std::mutex> lock(mtx);
+        int leaks = 0;
+        long long sum = 0;
+        for(int c : liveCount){
+            if(c < 0 || c > maxPerOwner) leaks++;
+            sum += c;
+        }
+        return leaks + (int)std::abs(sum - (long long)x.size());
     }
 };
 
 class ObjectsPool{
 private:
     std::vector<Tank*> Tankpool;
-    std::queue<Bullet*> Bulletpool;
+    BulletSystem Bullets;
     // std::vector<char> tank_symbol = {'O', 'A', 'T', 'X'};
     std::mutex t_mtx;
-    std::mutex b_mtx;
+    Arena* arena; // optional per-match arena for the tanks
 
-public:
-    ObjectsPool(){
+    Tank* newTank(int x, int y, char sym, int hp, int id){
+        if(arena) return arena->make<Tank>(x, y, sym, hp, id);
+        return new Tank(x, y, sym, hp, id);
+    }
 
+    // arena tanks only need their destructor, the memory goes back with the arena
+    void freeTank(Tank* t){
+        if(arena) t->~Tank();
+        else delete t;
+    }
+
+public:
+    ObjectsPool(Arena* matchArena = nullptr) : arena(matchArena){
+        Tankpool.reserve(4);
     }
     // automatically create player tank & at least one ai tank
     void createTank(Map& map, int tank_n=1, int health=1){
 
         int width = map.getwidth(), height = map.getheight();
-        std::vector<std::pair<int,int>> pos = {{1,1}, {width-1, 1}, {1, height-1}, {width-2, height-1}};
+        std::vector<std::pair<int,int>> pos = {{1,1}, {width-2, 1}, {1, height-2}, {width-2, height-2}};
 
         for(int i = 0; i <= 3 && i <= tank_n; ++i){
             {
                 std::lock_guard<std::mutex> lock(t_mtx);
-                Tankpool.emplace_back(new Tank(pos[i].first, pos[i].second, 'v', health, i));
+                Tankpool.emplace_back(newTank(pos[i].first, pos[i].second, 'v', health, i));
             }
             Tankpool[i]->setup_tank(map);
         }
     }
-    
-    void addBullet(int x, int y, int id, char d){
-        std::lock_guard<std::mutex> lock(b_mtx);
-        Bulletpool.push(new Bullet(x, y, id, d));
+
+    // destroy every tank, needed before the arena they live in is rewound
+    void releaseTanks(){
+        std::lock_guard<std::mutex> lock(t_mtx);
+        for(Tank* tank : Tankpool)
+            freeTank(tank);
+        Tankpool.clear();
     }
 
+    // start a new match on a reset map, bullet storage keeps its capacity
+    // the session calls releaseTanks() and rewinds the match arena first, so every tank is rebuilt in the fresh arena,
+    // tanks still in the pool (no arena, no release) are reset in place
+    void reset(Map& map, int tank_n=1, int health=1){
+
+        int width = map.getwidth(), height = map.getheight();
+        std::vector<std::pair<int,int>> pos = {{1,1}, {width-2, 1}, {1, height-2}, {width-2, height-2}};
+        int count = std::min(tank_n, 3) + 1;
+
+        Bullets.clear();
+        {
+            std::lock_guard<std::mutex> lock(t_mtx);
+            while((int)Tankpool.size() > count){
+                freeTank(Tankpool.back());
+                Tankpool.pop_back();
+            }
+            for(int i = 0; i < count; ++i){
+                if(i < (int)Tankpool.size())
+                    Tankpool[i]->reset(pos[i].first, pos[i].second, 'v', health);
+                else
+                    Tankpool.emplace_back(newTank(pos[i].first, pos[i].second, 'v', health, i));
+            }
+        }
+        for(int i = 0; i < count; ++i)
+            Tankpool[i]->setup_tank(map);
+    }
+    
     ~ObjectsPool() {
         for (Tank* tank : Tankpool) {
-            delete tank;
-        }
-        while(!Bulletpool.empty()){
-            Bulletpool.pop();
+            freeTank(tank);
         }
     }
 
@@ -419,26 +731,8 @@ public:
         std::lock_guard<std::mutex> lock(t_mtx);
         return Tankpool;
     }
-    std::queue<Bullet*> getBulletPool(){
-        std::lock_guard<std::mutex> lock(b_mtx);
-        return Bulletpool;
-    }
-    Bullet* getBullet(){
-        std::lock_guard<std::mutex> lock(b_mtx);
-        if(!Bulletpool.empty()){
-            Bullet* bullet = (Bullet*) malloc(sizeof(Bullet));
-            bullet = std::move(Bulletpool.front());
-            Bulletpool.pop();
-            return bullet;  
-        }
-        else return nullptr;
-          
-    }
-    void delBullet(){
-        std::lock_guard<std::mutex> lock(b_mtx);
-        Bullet* tmp = Bulletpool.front();
-        delete tmp;
-        Bulletpool.pop();
+    BulletSystem& getBullets(){
+        return Bullets;
     }
     
 };
\ No newline at end of file
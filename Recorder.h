@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <iostream>
+#include <sys/stat.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include "Objects.h"
+#include "Match.h"
+
+struct RecordConfig {
+    std::string dir = "frames";
+    std::string format = "ppm"; // ppm or png
+    int frames = 300; // stop after this many frames, or when the match ends
+    int every = 1; // capture every n ticks
+    int threads = 0; // encoder workers, 0 = one per core
+    int maxInFlight = 0; // frames waiting for an encoder before the simulation blocks, 0 = 4 per worker
+    MatchConfig match;
+};
+
+// a captured frame waiting to be encoded, buffers are recycled between frames
+struct CapturedFrame {
+    int index;
+    int width, height;
+    std::vector<uint8_t> rgba;
+};
+
+class FrameEncoder {
+private:
+    std::string dir, format;
+    int maxInFlight;
+    std::vector<CapturedFrame*> freeFrames;
+    int inFlight;
+    std::atomic<int> failed;
+    std::mutex mtx;
+    std::condition_variable cv;
+    ThreadPool pool;
+
+    bool writePPM(const CapturedFrame& f, const std::string& path){
+        FILE* fp = fopen(path.c_str(), "wb");
+        if(!fp) return false;
+        fprintf(fp, "P6\n%d %d\n255\n", f.width, f.height);
+        std::vector<uint8_t> row(f.width * 3);
+        for(int y = 0; y < f.height; ++y){
+            const uint8_t* src = f.rgba.data() + y * f.width * 4;
+            for(int x = 0; x < f.width; ++x){
+                row[x * 3] = src[x * 4];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + 2];
+            }
+            fwrite(row.data(), 1, row.size(), fp);
+        }
+        return fclose(fp) == 0;
+    }
+
+    bool writePNG(const CapturedFrame& f, const std::string& path){
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, f.width, f.height, 32, SDL_PIXELFORMAT_RGBA32);
+        if(!surface) return false;
+        for(int y = 0; y < f.height; ++y)
+            memcpy((uint8_t*)surface->pixels + y * surface->pitch, f.rgba.data() + y * f.width * 4, f.width * 4);
+        bool ok = IMG_SavePNG(surface, path.c_str()) == 0;
+        SDL_FreeSurface(surface);
+        return ok;
+    }
+
+    void encode(CapturedFrame* f){
+        char name[32];
+        snprintf(name, sizeof(name), "/frame_%05d.%s", f->index, format.c_str());
+        std::string path = dir + name;
+        bool ok = format == "png" ? writePNG(*f, path) : writePPM(*f, path);
+        if(!ok){
+            failed++;
+            std::cerr << "[ERROR] Failed to write " << path << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        freeFrames.push_back(f);
+        inFlight--;
+        cv.notify_all();
+    }
+
+public:
+    FrameEncoder(const std::string& outDir, const std::string& fmt, int threads, int maxFrames) :
+        dir(outDir), format(fmt), maxInFlight(maxFrames), inFlight(0), failed(0), pool(threads){}
+
+    ~FrameEncoder(){
+        finish();
+        for(CapturedFrame* f : freeFrames) delete f;
+    }
+
+    // copy the surface into a recycled buffer and hand it to a worker, blocks only when maxInFlight frames are queued
+    void submit(SDL_Surface* surface, int index){
+        CapturedFrame* f;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return inFlight < maxInFlight; });
+            inFlight++;
+            if(freeFrames.empty()){
+                f = new CapturedFrame();
+            }
+            else{
+                f = freeFrames.back();
+                freeFrames.pop_back();
+            }
+        }
+        f->index = index;
+        f->width = surface->w;
+        f->height = surface->h;
+        f->rgba.resize(surface->w * surface->h * 4);
+        SDL_LockSurface(surface);
+        for(int y = 0; y < surface->h; ++y)
+            memcpy(f->rgba.data() + y * surface->w * 4, (uint8_t*)surface->pixels + y * surface->pitch, surface->w * 4);
+        SDL_UnlockSurface(surface);
+        pool.enqueue([this, f]() { encode(f); });
+    }
+
+    void finish(){
+        pool.waitIdle();
+    }
+
+    int getFailed() const {
+        return failed;
+    }
+};
+
+// play a headless match and record it, rendering goes to a software surface so no window or display is needed
+inline bool runRecording(const RecordConfig& cfg){
+    int threads = cfg.threads > 0 ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+    int maxInFlight = cfg.maxInFlight > 0 ? cfg.maxInFlight : threads * 4;
+    if(mkdir(cfg.dir.c_str(), 0755) != 0 && errno != EEXIST){
+        std::cerr << "Failed to create " << cfg.dir << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    int width = cfg.match.width * 20, height = cfg.match.height * 20;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    if(!surface){
+        std::cerr << "Failed to create surface: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_Renderer* offscreen = SDL_CreateSoftwareRenderer(surface);
+    if(!offscreen){
+        std::cerr << "Failed to create software renderer: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(surface);
+        return false;
+    }
+
+    MatchConfig mc = cfg.match;
+    if(!mc.seed) mc.seed = 1;
+    Match match(mc);
+    int captured = 0;
+    int failed = 0;
+    double renderTime = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        FrameEncoder encoder(cfg.dir, cfg.format, threads, maxInFlight);
+        bool running = true;
+        while(running && captured < cfg.frames){
+            if(match.getTick() % std::max(cfg.every, 1) == 0){
+                auto renderStart = std::chrono::steady_clock::now();
+                match.display(offscreen);
+                SDL_RenderPresent(offscreen);
+                encoder.submit(surface, captured++);
+                renderTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+            }
+            running = match.step();
+        }
+        auto simEnd = std::chrono::steady_clock::now();
+        double simTime = std::chrono::duration<double>(simEnd - start).count();
+        encoder.finish();
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        failed = encoder.getFailed();
+
+        std::cout << "Recorded " << captured << " frames of " << match.getTick() << " ticks to " << cfg.dir << "/ (" << cfg.format << ")" << std::endl;
+        std::cout << "Simulation + capture: " << simTime << " s (" << match.getTick() / std::max(simTime, 1e-9) << " ticks/sec, "
+                  << renderTime / std::max(captured, 1) * 1000 << " ms per frame render), encoding done after " << total << " s on "
+                  << threads << " workers" << std::endl;
+        if(failed)
+            std::cerr << failed << " of " << captured << " frames failed to write" << std::endl;
+    }
+
+    SDL_DestroyRenderer(offscreen);
+    SDL_FreeSurface(surface);
+    return failed == 0;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include "Objects.h"
+
+struct StressConfig {
+    double seconds = 10;
+    int tanks = 256;
+    int threads = 0; // movers, 0 = one per core
+    int width = 200;
+    int height = 200;
+    int health = 5;
+    int maxBulletsPerTank = 64;
+    unsigned seed = 1;
+};
+
+struct StressReport {
+    long long moves = 0, moveAttempts = 0, shots = 0, ticks = 0, bulletSteps = 0, checks = 0;
+    long long cellViolations = 0; // a live tank missing from the grid or on more than one cell
+    long long healthViolations = 0; // negative health
+    long long bulletLeaks = 0; // bullet bookkeeping mismatches, including bullets left after draining
+    int peakBullets = 0;
+    double elapsed = 0;
+};
+
+/*
+    Push the engine from every core at once: mover threads move tanks and fire,
+    one thread steps the bullets as fast as it can, one thread keeps checking the invariants.
+*/
+inline StressReport runStress(const StressConfig& cfg){
+    int threads = cfg.threads > 0 ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+    Map map(cfg.width, cfg.height, cfg.seed);
+    map.addObstacle();
+    BulletSystem bullets(cfg.tanks, 1, cfg.maxBulletsPerTank);
+    bullets.reserve((size_t)cfg.tanks * cfg.maxBulletsPerTank, cfg.width * cfg.height);
+
+    // place the tanks on distinct free cells
+    std::vector<Tank*> tanks;
+    std::mt19937 gen(cfg.seed);
+    std::uniform_int_distribution<> distX(1, cfg.width - 2), distY(1, cfg.height - 2);
+    int attempts = 0;
+    while((int)tanks.size() < cfg.tanks && attempts++ < cfg.width * cfg.height * 4){
+        int x = distX(gen), y = distY(gen);
+        int id = (int)tanks.size();
+        if(map.tryPlace(x, y, 'v', id + 2))
+            tanks.push_back(new Tank(x, y, 'v', cfg.health, id));
+    }
+    if((int)tanks.size() < cfg.tanks){
+        std::cerr << "[WARN] only " << tanks.size() << " tanks fit on the map" << std::endl;
+    }
+
+    StressReport report;
+    std::atomic<bool> running(true);
+    std::atomic<long long> moves(0), moveAttempts(0), shots(0);
+    std::vector<std::thread> workers;
+
+    // movers, each owns a slice of the tanks
+    for(int w = 0; w < threads; ++w){
+        workers.emplace_back([&, w]() {
+            std::mt19937 rng(cfg.seed + 7919 * (w + 1));
+            static const int dirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            long long m = 0, a = 0, s = 0;
+            size_t begin = tanks.size() * w / threads, end = tanks.size() * (w + 1) / threads;
+            while(running && begin < end){
+                Tank* t = tanks[begin + rng() % (end - begin)];
+                int d = rng() % 4;
+                a++;
+                if(t->move(dirs[d][0], dirs[d][1], map)) m++;
+                if(rng() % 4 == 0 && t->is_alive() && bullets.spawn(t->getX(), t->getY(), t->getId(), t->getDirection())) s++;
+            }
+            moves += m;
+            moveAttempts += a;
+            shots += s;
+        });
+    }
+
+    // bullet stepper, no sleeps
+    workers.emplace_back([&]() {
+        std::vector<int> hits;
+        GameMetrics& metrics = GameMetrics::get();
+        while(running){
+            metrics.ticks.inc();
+            metrics.liveBullets.set(bullets.size());
+            report.peakBullets = std::max(report.peakBullets, bullets.size());
+            report.bulletSteps += bullets.size();
+            hits.clear();
+            bullets.step(map, hits);
+            for(int id : hits)
+                if(tanks[id]->is_alive()) tanks[id]->applyDamage(map);
+            report.ticks++;
+        }
+    });
+
+    // invariant checker
+    workers.emplace_back([&]() {
+        std::vector<std::pair<char, int>> cells;
+        std::vector<int> seen(tanks.size());
+        while(running){
+            map.copyCells(cells);
+            std::fill(seen.begin(), seen.end(), 0);
+            for(auto const& c:cells)
+                if(c.second >= 2 && c.second - 2 < (int)seen.size()) seen[c.second - 2]++;
+            for(size_t i = 0; i < tanks.size(); ++i){
+                // health only goes down, a tank alive now was alive when the grid was copied
+                if(tanks[i]->is_alive() && seen[i] != 1) report.cellViolations++;
+                if(tanks[i]->getHealth() < 0) report.healthViolations++;
+            }
+            report.bulletLeaks += bullets.countLeaks();
+            report.checks++;
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(cfg.seconds));
+    running = false;
+    for(auto& w:workers) w.join();
+    report.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // every bullet must eventually leave the map, anything left after draining is leaked
+    std::vector<int> hits;
+    for(int i = 0; i < cfg.width + cfg.height && bullets.size() > 0; ++i){
+        hits.clear();
+        bullets.step(map, hits);
+        for(int id : hits)
+            if(tanks[id]->is_alive()) tanks[id]->applyDamage(map);
+    }
+    report.bulletLeaks += bullets.size() + bullets.countLeaks();
+
+    report.moves = moves;
+    report.moveAttempts = moveAttempts;
+    report.shots = shots;
+    for(Tank* t : tanks) delete t;
+
+    double s = std::max(report.elapsed, 1e-9);
+    std::cout << "Stress: " << tanks.size() << " tanks, " << threads << " mover threads, " << report.elapsed << " s" << std::endl;
+    std::cout << "Moves/sec: " << report.moves / s << " (" << report.moveAttempts / s << " attempts/sec)" << std::endl;
+    std::cout << "Shots/sec: " << report.shots / s << ", ticks/sec: " << report.ticks / s
+              << ", bullet steps/sec: " << report.bulletSteps / s << ", peak bullets: " << report.peakBullets << std::endl;
+    std::cout << "Invariant checks: " << report.checks << ", cell violations: " << report.cellViolations
+              << ", health violations: " << report.healthViolations << ", bullet leaks: " << report.bulletLeaks << std::endl;
+    return report;
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+
+/*
+    Hierarchical timer wheel driven by the tick loop.
+    Three levels of 64 slots cover 64^3 ticks; schedule() and each advance() are O(1),
+    far timers cascade down a level when their slot comes round.
+    Entries come from a preallocated pool, a callback small enough for std::function's
+    inline storage (e.g. a lambda capturing two pointers) never touches the heap.
+*/
+class TimerWheel {
+private:
+    static const int Bits = 6;
+    static const int Slots = 1 << Bits;
+    static const int Levels = 3;
+    static const uint64_t Mask = Slots - 1;
+
+    struct Timer {
+        uint64_t expires;
+        int next; // next timer in the same slot, -1 = end
+        std::function<void()> fn;
+    };
+
+    std::vector<Timer> timers; // entry pool
+    int freeList;
+    int slots[Levels][Slots]; // head index per slot, -1 = empty
+    std::vector<std::function<void()>> due; // callbacks fired this tick
+    uint64_t now;
+    int pending;
+    std::mutex mtx;
+
+    int allocTimer() {
+        if (freeList < 0) {
+            timers.push_back({0, -1, nullptr});
+            return (int)timers.size() - 1;
+        }
+        int i = freeList;
+        freeList = timers[i].next;
+        return i;
+    }
+
+    // link a timer into the lowest level whose range covers its remaining delay
+    void place(int i) {
+        uint64_t expires = timers[i].expires;
+        uint64_t delay = expires - now;
+        int level = 0;
+        if (delay >= (uint64_t)Slots * Slots) {
+            level = 2;
+            uint64_t maxDelay = ((uint64_t)1 << (Bits * Levels)) - 1;
+            if (delay > maxDelay) expires = timers[i].expires = now + maxDelay;
+        }
+        else if (delay >= (uint64_t)Slots) {
+            level = 1;
+        }
+        int slot = (int)((expires >> (Bits * level)) & Mask);
+        timers[i].next = slots[level][slot];
+        slots[level][slot] = i;
+    }
+
+    void cascade(int level) {
+        int slot = (int)((now >> (Bits * level)) & Mask);
+        int i = slots[level][slot];
+        slots[level][slot] = -1;
+        while (i >= 0) {
+            int next = timers[i].next;
+            place(i);
+            i = next;
+        }
+    }
+
+public:
+    TimerWheel(size_t capacity = 256) : freeList(-1), now(0), pending(0) {
+        timers.reserve(capacity);
+        due.reserve(capacity);
+        for (int l = 0; l < Levels; ++l)
+            for (int s = 0; s < Slots; ++s)
+                slots[l][s] = -1;
+    }
+
+    // run fn after delay ticks (at least 1)
+    void schedule(int delay, std::function<void()> fn) {
+        std::lock_guard<std::mutex> lock(mtx);
+        int i = allocTimer();
+        timers[i].expires = now + (delay < 1 ? 1 : delay);
+        timers[i].fn = std::move(fn);
+        place(i);
+        pending++;
+    }
+
+    // move to the next tick and fire everything that expires on it, callbacks run without the lock held
+    void advance() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            now++;
+            if ((now & Mask) == 0) {
+                if (((now >> Bits) & Mask) == 0)
+                    cascade(2);
+                cascade(1);
+            }
+            int slot = (int)(now & Mask);
+            int i = slots[0][slot];
+            slots[0][slot] = -1;
+            while (i >= 0) {
+                int next = timers[i].next;
+                due.push_back(std::move(timers[i].fn));
+                timers[i].fn = nullptr;
+                timers[i].next = freeList;
+                freeList = i;
+                pending--;
+                i = next;
+            }
+        }
+        for (auto& fn : due) fn();
+        due.clear();
+    }
+
+    uint64_t getTick() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return now;
+    }
+
+    int size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return pending;
+    }
+};
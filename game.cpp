@@ -6,6 +6,13 @@
 #include <SDL2/SDL_ttf.h>
 #include <condition_variable>
 #include "Objects.h"
+#include "Match.h"
+#include "FrameStats.h"
+#include "Stress.h"
+#include "Recorder.h"
+#include "Metrics.h"
+#include "Arena.h"
+#include "TimerWheel.h"
 #include "logger.h"
 #include <atomic>
 
@@ -17,18 +24,37 @@
     #define LOG(message) // do nothing
 #endif
 
+// count every heap allocation against the calling thread's subsystem (see AllocStats)
+// noinline keeps gcc from pairing the inlined malloc/free with new/delete and warning about a mismatch
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    AllocStats::record(size);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
 
-std::mutex bulletMutex;                   
-std::vector<bool> bulletActive(4, false);
-std::atomic<bool> gameRunning(true);
+StopToken gameStop; // requested when the match ends, wakes every waiting game thread
 std::atomic<int> aiTank_n(1);
 std::ofstream logFile("log.txt");
 ThreadPool threadPool(12);
-
-std::condition_variable gameCondition;
-std::mutex gameMutex;
+const int TICK_MS = 60; // simulation step, drives bullets and every timed effect
+const int AI_STEP_TICKS = 3; // ~200 ms between an ai tank's horizontal and vertical step
+const int AI_THINK_TICKS = 8; // ~500 ms pause before its next decision
+const int TANK_SLIDE_MS = 80; // tanks glide to the new cell over this time
+int refreshRate = 60; // display refresh rate, the render loop paces itself to it
+bool vsyncEnabled = false;
+FrameStats frameStats;
 
 
 bool initSDL(int screenWidth, int screenHeight) {
@@ -45,11 +71,20 @@ bool initSDL(int screenWidth, int screenHeight) {
         std::cerr << "Failed to create window: " << SDL_GetError() << std::endl;
         return false;
     }
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
         std::cerr << "Failed to create renderer: " << SDL_GetError() << std::endl;
         return false;
     }
+
+    // pace frames to the display, SDL_RenderPresent blocks on vsync when the driver supports it
+    SDL_DisplayMode mode;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0)
+        refreshRate = mode.refresh_rate;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0)
+        vsyncEnabled = (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+    frameStats.setTarget(1000.0 / refreshRate);
     return true;
 }
 
@@ -60,20 +95,24 @@ void closeSDL() {
     SDL_Quit();
 }
 
-void renderText(const std::string& message, int x, int y, SDL_Color color, TTF_Font* font) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, message.c_str(), color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+void renderText(SDL_Renderer* target, const char* message, int x, int y, SDL_Color color, TTF_Font* font) {
+    SDL_Surface* surface = TTF_RenderText_Solid(font, message, color);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(target, surface);
     SDL_Rect rect = { x, y, surface->w, surface->h };
     SDL_FreeSurface(surface);
-    SDL_RenderCopy(renderer, texture, nullptr, &rect);
+    SDL_RenderCopy(target, texture, nullptr, &rect);
     SDL_DestroyTexture(texture);
 }
 
+void renderText(const char* message, int x, int y, SDL_Color color, TTF_Font* font) {
+    renderText(renderer, message, x, y, color, font);
+}
+
 char meunInput(bool &menuRunning){
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
-            gameRunning = false;  // exit
+            gameStop.requestStop();  // exit
             menuRunning = false;
         } 
         else if (event.type == SDL_KEYDOWN) {
@@ -151,11 +190,12 @@ void displayMenu(int& health, int& aiTankCount) {
     TTF_CloseFont(font);
 }
 
-void displayEnd(const char* message) {
+// return true if the player wants another match
+bool displayEnd(const char* message) {
     TTF_Font* font = TTF_OpenFont("arial.ttf", 24);
     if (!font) {
         std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        return;
+        return false;
     }
 
     SDL_Color white = { 255, 255, 255, 255 };
@@ -164,37 +204,43 @@ void displayEnd(const char* message) {
     SDL_RenderClear(renderer);
 
     renderText(message, 100, 100, white, font);
-    renderText("Press ESC to Quit", 100, 150, white, font);
+    renderText("Press R to Play Again, ESC to Quit", 100, 150, white, font);
 
     SDL_RenderPresent(renderer);
 
+    bool restart = false;
     bool endScreen = true;
     while (endScreen) {
         SDL_Event e;
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
                 endScreen = false;
-                gameRunning = false;
             } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
                 endScreen = false;
-                gameRunning = false;
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_r) {
+                endScreen = false;
+                restart = true;
             }
         }
+        SDL_Delay(16);
     }
 
     TTF_CloseFont(font);
+    return restart;
 }
 
 
-void displayHealth(const std::vector<Tank*>& tankPool, SDL_Renderer* renderer, TTF_Font* font) {
+// per-frame text is formatted into the frame's scratch arena instead of std::string
+void displayHealth(const std::vector<Tank*>& tankPool, SDL_Renderer* renderer, TTF_Font* font, Arena& scratch) {
     SDL_Color white = {255, 255, 255, 255};
     int x = 1210;  // x-axis
     int y = 10;  // y-axis
     for (const auto& tank : tankPool) {
         if (tank->is_alive()) {
-            std::string text = "Tank " + std::to_string(tank->getId()) + "(" + tank->getSymbol()+ ")" + " HP: " + std::to_string(tank->getHealth());
+            char* text = scratch.allocArray<char>(64);
+            snprintf(text, 64, "Tank %d(%c) HP: %d", tank->getId(), tank->getSymbol(), tank->getHealth());
             
-            SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), white);
+            SDL_Surface* surface = TTF_RenderText_Solid(font, text, white);
             SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 
             SDL_Rect rect = {x, y, surface->w, surface->h}; 
@@ -208,23 +254,115 @@ void displayHealth(const std::vector<Tank*>& tankPool, SDL_Renderer* renderer, T
     }
 }
 
+void displayFrameStats(SDL_Renderer* renderer, TTF_Font* font) {
+    SDL_Color white = {255, 255, 255, 255};
+    FrameStats::Snapshot s = frameStats.get();
+    char text[64];
+    snprintf(text, sizeof(text), "FPS: %.1f (%d Hz%s)", s.fps, refreshRate, vsyncEnabled ? " vsync" : "");
+    renderText(renderer, text, 1210, 700, white, font);
+    snprintf(text, sizeof(text), "Jitter: %.2f ms", s.jitterMs);
+    renderText(renderer, text, 1210, 725, white, font);
+    snprintf(text, sizeof(text), "Missed: %lld", s.missed);
+    renderText(renderer, text, 1210, 750, white, font);
+}
 
-void bulletController(ObjectsPool* objpool, Map& gameMap){
 
-    Bullet* b = objpool->getBullet();
+// an ai tank driven by the timer wheel, its steps are chained as timer entries instead of sleeps
+struct AiTank {
+    Tank* self;
+    Tank* player;
+    ObjectsPool* objpool;
+    Map* map;
+    TimerWheel* timers;
+    int dx, dy; // distance to the player when the current decision was made
+};
 
-    std::unique_lock<std::mutex> lock(bulletMutex);
-    bulletActive[b->getId()] = true;
-    lock.unlock();
+void aiTankAttack(AiTank* ai);
 
-    
-    b->shoot(objpool->getTankPool(), gameMap, renderer);
+// controll ai tank moving: horizontal step now, vertical step and attack AI_STEP_TICKS later
+void aiTankThink(AiTank* ai){
+    AllocScope scope(ALLOC_AI);
+    Tank* aiTank = ai->self;
+    if(!aiTank->is_alive() || gameStop.stopRequested()) return;
+
+    ai->dx = ai->player->getX() - aiTank->getX();
+    ai->dy = ai->player->getY() - aiTank->getY();
 
-    lock.lock();
-    bulletActive[b->getId()] = false;
-    lock.unlock();
-  
-    LOG("end bulletController.\n" );
+    if(ai->dx < 0) aiTank->move(-1, 0, *ai->map); // left
+    else if (ai->dx > 0) aiTank->move(1, 0, *ai->map); // right
+
+    ai->timers->schedule(AI_STEP_TICKS, [ai]() { aiTankAttack(ai); });
+}
+
+void aiTankAttack(AiTank* ai){
+    AllocScope scope(ALLOC_AI);
+    Tank* aiTank = ai->self;
+    if(!aiTank->is_alive() || gameStop.stopRequested()) return;
+
+    if(ai->dy < 0) aiTank->move(0, -1, *ai->map); // up
+    else if (ai->dy > 0) aiTank->move(0, 1, *ai->map); // down
+
+    // attack
+    if (abs(ai->dx) <= 15 && abs(ai->dy) <= 15) {
+        if(ai->objpool->getBullets().spawn(aiTank->getX(), aiTank->getY(), aiTank->getId(), aiTank->getDirection())){
+            char text[64];
+            snprintf(text, sizeof(text), "%d AI bullet fired.", aiTank->getId());
+            LOG(text);
+        }
+    }
+    ai->timers->schedule(AI_THINK_TICKS, [ai]() { aiTankThink(ai); }); // speed of ai tank
+}
+
+// one tick: fire due timers (ai steps, end of hit flashes), step every bullet, apply hits in place
+void simulationLoop(ObjectsPool* objpool, Map& gameMap, Arena& matchArena){
+
+    AllocScope scope(ALLOC_SIM);
+    BulletSystem& bullets = objpool->getBullets();
+    std::vector<Tank*> tankPool = objpool->getTankPool();
+    std::vector<int> hits;
+    hits.reserve(64);
+    TimerWheel timers;
+
+    // ai state lives in the match arena next to the tanks and goes away with it
+    for(size_t i = 1; i < tankPool.size(); ++i){
+        AiTank* ai = matchArena.make<AiTank>(AiTank{tankPool[i], tankPool[0], objpool, &gameMap, &timers, 0, 0});
+        timers.schedule(1 + (int)i, [ai]() { aiTankThink(ai); }); // staggered start
+    }
+
+    GameMetrics& metrics = GameMetrics::get();
+    auto next = std::chrono::steady_clock::now();
+    const int warmup = 16; // ticks that may still size the reusable buffers
+    int tick = 0;
+    uint64_t steadyAllocs = 0;
+
+    while(!gameStop.stopRequested()){
+        uint64_t before = AllocStats::threadAllocations();
+        timers.advance();
+        hits.clear();
+        bullets.step(gameMap, hits);
+        metrics.ticks.inc();
+        metrics.liveBullets.set(bullets.size());
+        for(int id : hits){
+            Tank* t = tankPool[id];
+            if(!t->is_alive()) continue;
+            t->takeDamage(gameMap);
+            if(t->is_alive())
+                timers.schedule(HIT_FLASH_TICKS, [t]() { t->endFlash(); });
+            else if(t->getId() != 0 && --aiTank_n <= 0)
+                gameStop.requestStop();
+        }
+        if(++tick > warmup)
+            steadyAllocs += AllocStats::threadAllocations() - before;
+        // fixed tick rate, independent of how long the step took, resync after a stall instead of bursting to catch up
+        next += std::chrono::milliseconds(TICK_MS);
+        if (std::chrono::steady_clock::now() > next)
+            next = std::chrono::steady_clock::now() + std::chrono::milliseconds(TICK_MS);
+        gameStop.waitUntil(next);
+    }
+
+    char text[96];
+    snprintf(text, sizeof(text), "end simulationLoop, %llu heap allocations in steady-state ticks.\n", (unsigned long long)steadyAllocs);
+    LOG(text);
 }
 
 
@@ -232,7 +370,7 @@ char processInput() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
-            gameRunning = false;  // exit
+            gameStop.requestStop();  // exit
         } else if (event.type == SDL_KEYDOWN) {
             switch (event.key.keysym.sym) {
                 case SDLK_UP:
@@ -262,11 +400,11 @@ char processInput() {
 
 void updateGameLogic(ObjectsPool *objpool, Map& gameMap) {
 
+    AllocScope scope(ALLOC_INPUT);
     char command;
-    bool bullet_active = false;
     Tank *t = objpool->getplayer();
 
-    while (t->is_alive() && gameRunning){
+    while (t->is_alive() && !gameStop.stopRequested()){
         command = processInput();
         if(command == 'w')
             t->move(0, -1, gameMap); // up
@@ -277,27 +415,16 @@ void updateGameLogic(ObjectsPool *objpool, Map& gameMap) {
         else if(command == 'd')
             t->move(1, 0, gameMap);  // right
         else if(command == ' ' ){
-            std::unique_lock<std::mutex> lock(bulletMutex);
-            bullet_active = bulletActive[0];
-            lock.unlock();
-            if(!bullet_active){
-                objpool->addBullet(t->getX(), t->getY(), t->getId(), t->getDirection());
-                LOG("create bulletController.\n" );
-                threadPool.enqueue([&]() { bulletController(objpool, gameMap); });
-
-            }
-            
-            
+            if(objpool->getBullets().spawn(t->getX(), t->getY(), t->getId(), t->getDirection()))
+                LOG("player bullet fired.\n" );
         }
         else if(command == 'q'){
             break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-
-
+        gameStop.waitFor(std::chrono::milliseconds(16));
     }
 
-    gameRunning = false;
+    gameStop.requestStop();
     LOG("end updateGameLogic.\n" );
 }
 
@@ -311,70 +438,141 @@ void renderGame(Map& gameMap, ObjectsPool* objpool) {
         return;
     }
 
-    while (gameRunning) {
+    AllocScope scope(ALLOC_RENDER);
+    Arena frameScratch(4096); // per-frame strings, rewound every frame
+    using clock = std::chrono::steady_clock;
+    const clock::duration period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / refreshRate));
+    const clock::duration tick = std::chrono::milliseconds(TICK_MS);
+    const clock::duration slide = std::chrono::milliseconds(TANK_SLIDE_MS);
+    BulletSystem& bullets = objpool->getBullets();
+    std::vector<Tank*> tankPool = objpool->getTankPool();
+    Histogram& frameSeconds = GameMetrics::get().frameSeconds;
+    clock::time_point last = clock::now();
+    clock::time_point next = last + period;
+
+    while (!gameStop.stopRequested()) {
+        frameScratch.reset();
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
+        clock::time_point now = clock::now();
         gameMap.display(renderer);
+        bullets.display(renderer, now, tick);
+        for (auto const& t : tankPool)
+            t->display(renderer, now, slide);
 
-        std::vector<Tank*> tankPool = objpool->getTankPool();
-        displayHealth(tankPool, renderer, font);
+        displayHealth(tankPool, renderer, font, frameScratch);
+        displayFrameStats(renderer, font);
 
         SDL_RenderPresent(renderer);
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-    }
 
-    if (aiTank_n > 0) {
-        displayEnd("You lose...");
-    } else {
-        displayEnd("You Win!!!");
+        // without vsync wait for the next frame deadline, resync if we fell more than a frame behind
+        if (!vsyncEnabled) {
+            gameStop.waitUntil(next);
+            next += period;
+            if (clock::now() > next)
+                next = clock::now() + period;
+        }
+
+        now = clock::now();
+        frameStats.addFrame(std::chrono::duration<double, std::milli>(now - last).count());
+        frameSeconds.observe(std::chrono::duration<double>(now - last).count());
+        last = now;
     }
-    gameCondition.notify_one();
+
+    FrameStats::Snapshot s = frameStats.get();
+    LOG("frames: " + std::to_string(s.frames) + ", avg " + std::to_string(s.avgMs) + " ms, jitter " + std::to_string(s.jitterMs)
+        + " ms, worst " + std::to_string(s.worstMs) + " ms, missed " + std::to_string(s.missed) + "\n");
+
+    TTF_CloseFont(font);
 }
 
-// controll ai tank moving
-void aiTankController(ObjectsPool* objpool, Tank *aiTank, Tank *playerTank, Map& gameMap){
-    int id = aiTank->getId();
-    bool bullet_active = false;
-    while(aiTank->is_alive() && gameRunning){
-        
-        if (!gameRunning) break;
+// value following a command line flag, e.g. --tanks 3
+int getArg(int argc, char** argv, const std::string& flag, int def) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (flag == argv[i]) return atoi(argv[i + 1]);
+    }
+    return def;
+}
 
-        int dx = playerTank->getX() - aiTank->getX();
-        int dy = playerTank->getY() - aiTank->getY();
-        
-        if(dx < 0) aiTank->move(-1, 0, gameMap); // left
-        else if (dx > 0) aiTank->move(1, 0, gameMap); // right
+std::string getArg(int argc, char** argv, const std::string& flag, const std::string& def) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (flag == argv[i]) return argv[i + 1];
+    }
+    return def;
+}
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+bool hasArg(int argc, char** argv, const std::string& flag) {
+    for (int i = 1; i < argc; ++i) {
+        if (flag == argv[i]) return true;
+    }
+    return false;
+}
 
-        if(dy < 0) aiTank->move(0, -1, gameMap); // up
-        else if (dy > 0) aiTank->move(0, 1, gameMap); // down
-        
+int main(int argc, char** argv) {
 
-        // attack
-        if (abs(dx) <= 15 && abs(dy) <= 15) {
-            std::unique_lock<std::mutex> lock(bulletMutex);
-            bullet_active = bulletActive[id];
-            lock.unlock();
-            if(!bullet_active){
-                objpool->addBullet(aiTank->getX(), aiTank->getY(), id, aiTank->getDirection());
-                std::string tmp = std::to_string(id) + "create AI bulletController." ;
-                threadPool.enqueue([&]() { bulletController(objpool, gameMap); });
-                LOG(tmp);
-            }
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(500)); // speed of ai tank
+    // prometheus metrics: --metrics-socket /tmp/tankgame.sock or --metrics-port 9100 (loopback only)
+    MetricsServer metricsServer;
+    threadPool.setQueueGauge(&GameMetrics::get().poolQueueDepth);
+    bool metricsOk = true;
+    if (hasArg(argc, argv, "--metrics-socket"))
+        metricsOk = metricsServer.startUnix(getArg(argc, argv, "--metrics-socket", std::string("/tmp/tankgame.sock")));
+    else if (hasArg(argc, argv, "--metrics-port"))
+        metricsOk = metricsServer.startTcp(getArg(argc, argv, "--metrics-port", 9100));
+    if (!metricsOk) return 1;
+
+    // headless batch mode: ./game --tournament 1000 [--threads n --width w --height h --tanks n --health n --max-ticks n --lookahead n --bullet-speed n --fire-interval n --max-bullets n --seed n --out file.csv]
+    if (hasArg(argc, argv, "--tournament")) {
+        TournamentConfig cfg;
+        cfg.matches = std::max(getArg(argc, argv, "--tournament", cfg.matches), 1);
+        cfg.threads = getArg(argc, argv, "--threads", cfg.threads);
+        cfg.match.width = std::max(getArg(argc, argv, "--width", cfg.match.width), 10);
+        cfg.match.height = std::max(getArg(argc, argv, "--height", cfg.match.height), 10);
+        cfg.match.aiTanks = std::min(std::max(getArg(argc, argv, "--tanks", cfg.match.aiTanks), 1), 3);
+        cfg.match.health = std::min(std::max(getArg(argc, argv, "--health", cfg.match.health), 1), 9);
+        cfg.match.maxTicks = std::max(getArg(argc, argv, "--max-ticks", cfg.match.maxTicks), 1);
+        cfg.match.lookahead = std::max(getArg(argc, argv, "--lookahead", cfg.match.lookahead), 0);
+        cfg.match.bulletSpeed = std::min(std::max(getArg(argc, argv, "--bullet-speed", cfg.match.bulletSpeed), 1), 127);
+        cfg.match.fireInterval = std::min(std::max(getArg(argc, argv, "--fire-interval", cfg.match.fireInterval), 1), 100);
+        cfg.match.maxBullets = std::min(std::max(getArg(argc, argv, "--max-bullets", cfg.match.maxBullets), 1), (int)GameState::MaxBulletsPerTank);
+        cfg.match.seed = getArg(argc, argv, "--seed", 0);
+        cfg.out = getArg(argc, argv, "--out", cfg.out);
+        return runTournament(cfg) ? 0 : -1;
     }
 
-    aiTank_n--;
-    if(aiTank_n <= 0)
-        gameRunning = false;
-    LOG("end aiTankController.\n");
-}
+    // lookahead benchmark: ./game --bench-clone [--seconds s --threads n]
+    if (hasArg(argc, argv, "--bench-clone")) {
+        runCloneBenchmark(std::max(getArg(argc, argv, "--seconds", 4), 1), getArg(argc, argv, "--threads", 0));
+        return 0;
+    }
 
+    // concurrency stress test: ./game --stress 10 [--tanks n --threads n --width w --height h]
+    if (hasArg(argc, argv, "--stress")) {
+        StressConfig cfg;
+        cfg.seconds = std::max(getArg(argc, argv, "--stress", 10), 1);
+        cfg.tanks = std::max(getArg(argc, argv, "--tanks", cfg.tanks), 1);
+        cfg.threads = getArg(argc, argv, "--threads", cfg.threads);
+        cfg.width = std::max(getArg(argc, argv, "--width", cfg.width), 10);
+        cfg.height = std::max(getArg(argc, argv, "--height", cfg.height), 10);
+        StressReport r = runStress(cfg);
+        return r.cellViolations + r.healthViolations + r.bulletLeaks == 0 ? 0 : 1;
+    }
 
-int main(int argc, char** argv) {
+    // headless recording: ./game --record dir [--frames n --every n --format ppm|png --threads n --tanks n --health n --fire-interval n --max-bullets n --seed n]
+    if (hasArg(argc, argv, "--record")) {
+        RecordConfig cfg;
+        cfg.dir = getArg(argc, argv, "--record", cfg.dir);
+        cfg.frames = std::max(getArg(argc, argv, "--frames", cfg.frames), 1);
+        cfg.every = std::max(getArg(argc, argv, "--every", cfg.every), 1);
+        cfg.format = getArg(argc, argv, "--format", cfg.format) == "png" ? "png" : "ppm";
+        cfg.threads = getArg(argc, argv, "--threads", cfg.threads);
+        cfg.match.aiTanks = std::min(std::max(getArg(argc, argv, "--tanks", cfg.match.aiTanks), 1), 3);
+        cfg.match.health = std::min(std::max(getArg(argc, argv, "--health", cfg.match.health), 1), 9);
+        cfg.match.fireInterval = std::min(std::max(getArg(argc, argv, "--fire-interval", cfg.match.fireInterval), 1), 100);
+        cfg.match.maxBullets = std::min(std::max(getArg(argc, argv, "--max-bullets", cfg.match.maxBullets), 1), (int)GameState::MaxBulletsPerTank);
+        cfg.match.seed = getArg(argc, argv, "--seed", 0);
+        return runRecording(cfg) ? 0 : -1;
+    }
 
     if (!initSDL(1400, 800)) {
         return -1;
@@ -385,31 +583,49 @@ int main(int argc, char** argv) {
 
     displayMenu(health, aiTankCount);
 
-    aiTank_n = aiTankCount;
+    // one map and pool for the whole session, every match resets them in place
+    // tanks and ai state of the current match live in one arena, freed in one shot at every restart
     Map gameMap(60, 40);
-    gameMap.addObstacle();
-
-    ObjectsPool* objpool = new ObjectsPool();
-    objpool->createTank(gameMap, aiTankCount, health);
-
-    std::vector<Tank*> tankPool = objpool->getTankPool();
-
-    threadPool.enqueue([&]() { updateGameLogic(objpool, std::ref(gameMap)); });
-    threadPool.enqueue([&]() { renderGame(std::ref(gameMap), objpool); });
-
-
-    // if not ref i, it will cause Segmentation fault (core dumped)
-    for(int i = 1; i <= aiTank_n; ++i){
-        threadPool.enqueue([&, i]() { aiTankController(objpool, tankPool[i], tankPool[0], std::ref(gameMap)); });
+    Arena matchArena(4096);
+    ObjectsPool objpool(&matchArena);
+    ObjectsPool* pool = &objpool;
+    // same fire rate and bullet cap flags as the headless modes
+    MatchConfig rules;
+    rules.fireInterval = std::min(std::max(getArg(argc, argv, "--fire-interval", rules.fireInterval), 1), 100);
+    rules.maxBullets = std::min(std::max(getArg(argc, argv, "--max-bullets", rules.maxBullets), 1), (int)GameState::MaxBulletsPerTank);
+    objpool.getBullets().setFireRate(rules.fireInterval);
+    objpool.getBullets().setMaxPerOwner(rules.maxBullets);
+    objpool.getBullets().reserve(std::max(64, rules.maxBullets * 4), gameMap.getwidth() * gameMap.getheight());
+    bool playing = !gameStop.stopRequested();
+
+    while (playing) {
+        auto setupStart = std::chrono::steady_clock::now();
+        gameStop.reset();
+        aiTank_n = aiTankCount;
+        frameStats.reset();
+        gameMap.reset();
+        gameMap.addObstacle();
+        objpool.releaseTanks();
+        matchArena.reset();
+        objpool.reset(gameMap, aiTankCount, health);
+
+        threadPool.enqueue([pool, &gameMap]() { updateGameLogic(pool, gameMap); });
+        threadPool.enqueue([pool, &gameMap]() { renderGame(gameMap, pool); });
+        threadPool.enqueue([pool, &gameMap, &matchArena]() { simulationLoop(pool, gameMap, matchArena); }); // also runs the ai tanks
+        LOG("match started in " + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count()) + " ms\n");
+
+        gameStop.wait();
+
+        // every game thread wakes on the stop token, wait for them before touching the pool again
+        auto stopStart = std::chrono::steady_clock::now();
+        threadPool.waitIdle();
+        LOG("match stopped in " + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stopStart).count()) + " ms\n");
+
+        LOG("match arena: " + std::to_string(matchArena.bytesUsed()) + " of " + std::to_string(matchArena.bytesReserved()) + " bytes used\n");
+        LOG("heap allocations per subsystem:\n" + AllocStats::report());
+
+        playing = displayEnd(aiTank_n > 0 ? "You lose..." : "You Win!!!");
     }
-    
-    
-    {
-        std::unique_lock<std::mutex> lock(gameMutex);
-        gameCondition.wait(lock, [] { return !gameRunning; });
-    }
-
-    delete objpool;
 
     closeSDL();
     LOG("end main.\n");
@@ -10,7 +10,8 @@ public:
         return instance;
     }
 
-    void writeLog(const std::string& message) {
+    // plain C string overload, logging from a game loop does not build a std::string
+    void writeLog(const char* message) {
         // to stdout
         // std::cout << "[DEBUG] " << message << std::endl;
 
@@ -21,6 +22,10 @@ public:
         }
     }
 
+    void writeLog(const std::string& message) {
+        writeLog(message.c_str());
+    }
+
 private:
     std::ofstream logFile;
 